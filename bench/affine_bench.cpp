@@ -0,0 +1,162 @@
+// affine_bench.cpp
+// Affine3x4 vs glm::mat4 : ns par composition / transformation de point /
+// inverse, passe monde du squelette réécrite en mat4, et octets envoyés au
+// GPU par frame (attributs d'instance et uniform model).
+#include "bench_util.hpp"
+#include "affine.hpp"
+#include "character.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Transformations affines pseudo-aléatoires (rotation + échelle + translation)
+static void makeInputs(int n, std::vector<glm::mat4> &m, std::vector<Affine3x4> &a)
+{
+    m.resize(n);
+    a.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        glm::mat4 t = glm::translate(glm::mat4(1.0f), {0.1f * i, 1.0f, -0.3f * (i % 7)});
+        t = glm::rotate(t, 0.37f * i, glm::vec3(0.2f, 1.0f, 0.1f * (i % 3)));
+        t = glm::scale(t, glm::vec3(1.0f + 0.01f * (i % 5), 0.9f, 1.1f));
+        m[i] = t;
+        a[i] = Affine3x4(t);
+    }
+}
+
+// Même passe que Skeleton::computeWorld + computeParts, en mat4 (chemin d'avant)
+static void poseMat4(const Skeleton &S, const AnimChannels &ch, glm::mat4 *world, glm::mat4 *models)
+{
+    for (int i = 0; i < S.jointCount(); ++i)
+    {
+        glm::vec3 t = S.offset[i];
+        if (S.transChannel[i] >= 0)
+            t += S.transAxis[i] * ch[S.transChannel[i]];
+        glm::mat4 m = glm::translate(S.parent[i] < 0 ? glm::mat4(1.0f) : world[S.parent[i]], t);
+        if (S.rotChannel[i] >= 0)
+            m = glm::rotate(m, S.rotSign[i] * ch[S.rotChannel[i]], S.axis[i]);
+        world[i] = m;
+    }
+    for (int i = 0; i < S.partCount(); ++i)
+        models[i] = glm::scale(glm::translate(world[S.partJoint[i]], S.partCenter[i]), S.partScale[i]);
+}
+
+int main(int argc, char **argv)
+{
+    const int reps = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int n = 1024;
+    std::vector<glm::mat4> m, mOut(n);
+    std::vector<Affine3x4> a, aOut(n);
+    makeInputs(n, m, a);
+    const long ops = (long)reps * n;
+
+    std::printf("sizeof: mat4 %zu, Affine3x4 %zu bytes\n", sizeof(glm::mat4), sizeof(Affine3x4));
+
+    // Composition : out[i] = x[i] * x[(i + 1) % n]
+    const double composeM = nsPerOp(ops, [&]
+                                    {
+        for (int r = 0; r < reps; ++r)
+        {
+            for (int i = 0; i < n; ++i)
+                mOut[i] = m[i] * m[(i + 1) & (n - 1)];
+            g_sink = g_sink + mOut[r & (n - 1)][3][1];
+        } });
+    const double composeA = nsPerOp(ops, [&]
+                                    {
+        for (int r = 0; r < reps; ++r)
+        {
+            for (int i = 0; i < n; ++i)
+                aOut[i] = a[i] * a[(i + 1) & (n - 1)];
+            g_sink = g_sink + aOut[r & (n - 1)][1].w;
+        } });
+    std::printf("compose    ns/op: mat4 %6.2f  affine %6.2f  x%.2f\n", composeM, composeA, composeM / composeA);
+
+    const double pointM = nsPerOp(ops, [&]
+                                  {
+        float acc = 0.0f;
+        for (int r = 0; r < reps; ++r)
+            for (int i = 0; i < n; ++i)
+                acc += (m[i] * glm::vec4(0.5f, -0.5f, 0.25f * r, 1.0f)).y;
+        g_sink = acc; });
+    const double pointA = nsPerOp(ops, [&]
+                                  {
+        float acc = 0.0f;
+        for (int r = 0; r < reps; ++r)
+            for (int i = 0; i < n; ++i)
+                acc += transformPoint(a[i], {0.5f, -0.5f, 0.25f * r}).y;
+        g_sink = acc; });
+    std::printf("point      ns/op: mat4 %6.2f  affine %6.2f  x%.2f\n", pointM, pointA, pointM / pointA);
+
+    const double invM = nsPerOp(ops / 4, [&]
+                                {
+        for (int r = 0; r < reps / 4; ++r)
+        {
+            for (int i = 0; i < n; ++i)
+                mOut[i] = glm::inverse(m[i]);
+            g_sink = g_sink + mOut[r & (n - 1)][3][1];
+        } });
+    const double invA = nsPerOp(ops / 4, [&]
+                                {
+        for (int r = 0; r < reps / 4; ++r)
+        {
+            for (int i = 0; i < n; ++i)
+                aOut[i] = inverse(a[i]);
+            g_sink = g_sink + aOut[r & (n - 1)][1].w;
+        } });
+    float invErr = 0.0f; // |A * A⁻¹ - I|
+    for (int i = 0; i < n; ++i)
+    {
+        const Affine3x4 id = a[i] * inverse(a[i]);
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 4; ++c)
+                invErr = std::max(invErr, std::fabs(id[r][c] - (r == c ? 1.0f : 0.0f)));
+    }
+    std::printf("inverse    ns/op: mat4 %6.2f  affine %6.2f  x%.2f  (max |A*inv(A) - I| %.1e)\n", invM, invA,
+                invM / invA, invErr);
+
+    // Passe monde + pièces d'un personnage (walk), une pose = un appel
+    CharacterRenderer rig;
+    const Skeleton &S = rig.skeleton();
+    glm::mat4 worldM[kMaxJoints], modelsM[kMaxParts];
+    Affine3x4 worldA[kMaxJoints], modelsA[kMaxParts];
+    const long poses = (long)reps * 100;
+    const double rigM = nsPerOp(poses, [&]
+                                {
+        for (long p = 0; p < poses; ++p)
+        {
+            poseMat4(S, evalAnim(AnimMode::Walk, p * 0.0137f), worldM, modelsM);
+            g_sink = g_sink + modelsM[3][3][1];
+        } });
+    const double rigA = nsPerOp(poses, [&]
+                                {
+        for (long p = 0; p < poses; ++p)
+        {
+            S.computeWorld(evalAnim(AnimMode::Walk, p * 0.0137f), Affine3x4(), worldA);
+            S.computeParts(worldA, modelsA);
+            g_sink = g_sink + modelsA[3][1].w;
+        } });
+    float rigErr = 0.0f;
+    for (int i = 0; i < S.partCount(); ++i)
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 4; ++c)
+                rigErr = std::max(rigErr, std::fabs(modelsA[i][r][c] - modelsM[i][c][r]));
+    std::printf("rig pass   ns/char: mat4 %6.1f  affine %6.1f  x%.2f  (max err %.1e)\n", rigM, rigA, rigM / rigA,
+                rigErr);
+
+    // Octets GPU par frame : attributs d'instance (transformation + couleur)
+    // et, sur le chemin une pièce = un draw, l'uniform model
+    const size_t instM = sizeof(glm::mat4) + sizeof(glm::vec4), instA = sizeof(PartInstance);
+    std::printf("upload bytes/part: instance mat4 %zu affine %zu (-%.0f%%), uniform mat4 %zu affine %zu (-%.0f%%)\n",
+                instM, instA, 100.0 * (instM - instA) / instM, sizeof(glm::mat4), sizeof(Affine3x4),
+                100.0 * (sizeof(glm::mat4) - sizeof(Affine3x4)) / sizeof(glm::mat4));
+    for (int count : {1, 100, 1000, 10000})
+    {
+        const size_t parts = (size_t)count * rig.partCount();
+        std::printf("  %5d chars: instanced %8.1f -> %8.1f KiB/frame\n", count, parts * instM / 1024.0,
+                    parts * instA / 1024.0);
+    }
+    return 0;
+}
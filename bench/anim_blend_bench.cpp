@@ -0,0 +1,124 @@
+// anim_blend_bench.cpp
+// Mélanges d'animation (AnimBlend) sur une foule de 10k personnages : 1, 2 et
+// 4 sources (+ couche additive). Courbes seules (evalBlend par personnage vs
+// evalBlendBatch en SoA), puis poses complètes, analytiques et clips cuits.
+// Les mélanges à 2 et 4 sources sont produits par un AnimPlayer (fondus
+// enchaînés relancés en plein fondu).
+#include "bench_util.hpp"
+#include "anim_clip.hpp"
+#include "anim_graph.hpp"
+#include "character.hpp"
+#include "crowd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static std::string describe(const AnimBlend &b)
+{
+    static const char *const names[] = {"idle", "walk", "jump"};
+    std::string s;
+    char buf[64];
+    for (int k = 0; k < b.count; ++k)
+    {
+        std::snprintf(buf, sizeof(buf), "%s%s x%.1f %.2f", k ? " + " : "", names[(int)b.source[k].clip],
+                      b.source[k].speed, b.weight[k]);
+        s += buf;
+    }
+    for (int k = 0; k < b.layers; ++k)
+    {
+        std::snprintf(buf, sizeof(buf), " | layer %s %.2f", names[(int)b.layer[k].source.clip], b.layer[k].weight);
+        s += buf;
+    }
+    return s;
+}
+
+int main(int argc, char **argv)
+{
+    const int chars = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10000;
+    const int reps = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    // Mélanges : un état, un fondu walk → jump à mi-course, puis 4 états
+    // (walk → jump → idle → run, chaque play en plein fondu du précédent)
+    AnimGraph graph;
+    const int run = graph.addState("run", AnimSource{AnimMode::Walk, 1.8f});
+    graph.defaultFade = 0.5f;
+    AnimPlayer two(graph, (int)AnimMode::Walk);
+    two.play((int)AnimMode::Jump, 1.0f);
+    AnimPlayer four(graph, (int)AnimMode::Walk);
+    four.play((int)AnimMode::Jump, 1.0f);
+    four.play((int)AnimMode::Idle, 1.1f);
+    four.play(run, 1.2f);
+    AnimPlayer layered = four;
+    layered.setLayer(0, (int)AnimMode::Walk, 0.6f, 1u << ChElbow);
+
+    struct Case {
+        const char *name;
+        AnimBlend blend;
+    };
+    const Case cases[] = {{"1-way", AnimBlend(AnimMode::Walk)},
+                          {"2-way", two.blend(1.25f)},
+                          {"4-way", four.blend(1.3f)},
+                          {"4-way+layer", layered.blend(1.3f)}};
+
+    std::vector<float> t(chars);
+    std::vector<AnimChannels> a(chars), b(chars);
+    std::vector<Affine3x4> roots(chars);
+    for (int i = 0; i < chars; ++i)
+    {
+        t[i] = 12.5f + 3.0f * i / chars; // foule déphasée
+        roots[i] = crowdRoot(i, chars);
+    }
+    CharacterRenderer rig;
+    std::vector<PartInstance> out((size_t)chars * rig.partCount());
+    AnimLibrary lib;
+    bakeLibrary(rig.skeleton(), 30.0f, lib);
+    CharacterRenderer bakedRig;
+    bakedRig.setBaked(&lib);
+
+    std::printf("%d characters, %d parts each\n", chars, rig.partCount());
+    for (const Case &c : cases)
+        std::printf("  %-12s %s\n", c.name, describe(c.blend).c_str());
+
+    const long evals = (long)reps * 10 * chars, poses = (long)reps * chars;
+    std::printf("\n%-12s %30s %20s %20s\n", "", "curves ns/char (per-char | SoA)", "pose ns/char",
+                "baked pose ns/char");
+    for (const Case &c : cases)
+    {
+        const double nsOne = nsPerOp(evals, [&]
+                                     {
+            for (int r = 0; r < reps * 10; ++r)
+            {
+                for (int i = 0; i < chars; ++i)
+                    a[i] = evalBlend(c.blend, t[i]);
+                g_sink = g_sink + a[r % chars][ChSway];
+            } });
+        const double nsSoA = nsPerOp(evals, [&]
+                                     {
+            for (int r = 0; r < reps * 10; ++r)
+            {
+                evalBlendBatch(c.blend, t.data(), chars, b.data());
+                g_sink = g_sink + b[r % chars][ChSway];
+            } });
+        float err = 0.0f;
+        for (int i = 0; i < chars; ++i)
+            for (int ch = 0; ch < ChCount; ++ch)
+                err = std::max(err, std::fabs(a[i][ch] - b[i][ch]));
+        const double nsPose = nsPerOp(poses, [&]
+                                      {
+            for (int r = 0; r < reps; ++r)
+                rig.poseBatch(t.data(), chars, c.blend, false, roots.data(), out.data());
+            g_sink = g_sink + out[5].model[1].w; });
+        const double nsBaked = nsPerOp(poses, [&]
+                                       {
+            for (int r = 0; r < reps; ++r)
+                bakedRig.poseBatch(t.data(), chars, c.blend, false, roots.data(), out.data());
+            g_sink = g_sink + out[5].model[1].w; });
+        std::printf("%-12s %9.2f | %6.2f (x%.1f, %6.1f M/s) %13.1f (%4.2f M/s) %13.1f (%4.2f M/s)  diff %.1e\n",
+                    c.name, nsOne, nsSoA, nsOne / nsSoA, 1e3 / nsSoA, nsPose, 1e3 / nsPose, nsBaked, 1e3 / nsBaked,
+                    err);
+    }
+    return 0;
+}
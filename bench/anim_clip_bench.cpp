@@ -0,0 +1,142 @@
+// anim_clip_bench.cpp
+// Clips cuits vs courbes analytiques : précision (écart max sur les matrices
+// des pièces) et coût d'une pose complète en ns/personnage, par fréquence de clés.
+// Puis clips compressés vs bruts : octets par seconde de clip, décodage d'une
+// pose locale (ns) et écart ajouté par la quantification.
+#include "anim_clip.hpp"
+#include "character.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static double poseNs(const CharacterRenderer &rig, AnimMode mode, int n)
+{
+    PartInstance parts[kMaxParts];
+    float sink = 0.0f;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        rig.pose(i * 0.0137f, mode, false, Affine3x4(), parts);
+        sink += parts[3].model[1].w;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    volatile float keep = sink;
+    (void)keep;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+// Étape animation seule : canaux + passe monde (analytique) ou lookup + passe monde (cuit)
+static double animNs(const Skeleton &s, const AnimClip *clip, AnimMode mode, int n)
+{
+    Affine3x4 world[kMaxJoints];
+    glm::quat rot[kMaxJoints];
+    glm::vec3 trans[kMaxJoints];
+    float sink = 0.0f;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        const float t = i * 0.0137f;
+        if (clip)
+        {
+            sampleClip(*clip, t, rot, trans);
+            s.computeWorldLocal(rot, trans, Affine3x4(), world);
+        }
+        else
+            s.computeWorld(evalAnim(mode, t), Affine3x4(), world);
+        sink += world[2][1].w;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    volatile float keep = sink;
+    (void)keep;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+// Échantillonnage seul (pose locale de toutes les articulations)
+static double decodeNs(const AnimClip *raw, const CompressedClip *packed, int n)
+{
+    glm::quat rot[kMaxJoints];
+    glm::vec3 trans[kMaxJoints];
+    float sink = 0.0f;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        const float t = i * 0.0137f;
+        if (packed)
+            sampleCompressed(*packed, t, rot, trans);
+        else
+            sampleClip(*raw, t, rot, trans);
+        sink += rot[3].x + trans[0].y;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    volatile float keep = sink;
+    (void)keep;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+// Écart max entre les pièces posées par deux renderers
+static float maxPoseErr(const CharacterRenderer &a, const CharacterRenderer &b, AnimMode m)
+{
+    float maxErr = 0.0f;
+    PartInstance pa[kMaxParts], pb[kMaxParts];
+    for (int i = 0; i < 20000; ++i)
+    {
+        const float t = i * 0.00731f;
+        a.pose(t, m, false, Affine3x4(), pa);
+        b.pose(t, m, false, Affine3x4(), pb);
+        for (int p = 0; p < a.partCount(); ++p)
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 4; ++c)
+                    maxErr = std::max(maxErr, std::fabs(pa[p].model[r][c] - pb[p].model[r][c]));
+    }
+    return maxErr;
+}
+
+int main(int argc, char **argv)
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 200000;
+    CharacterRenderer analytic;
+    CharacterRenderer baked;
+    const char *names[] = {"idle", "walk", "jump"};
+
+    for (float rate : {15.0f, 30.0f, 60.0f, 120.0f})
+    {
+        AnimLibrary lib;
+        bakeLibrary(analytic.skeleton(), rate, lib);
+        baked.setBaked(&lib);
+        std::printf("rate=%5.0f Hz\n", rate);
+        for (AnimMode m : {AnimMode::Idle, AnimMode::Walk, AnimMode::Jump})
+        {
+            // Écart max sur les matrices des pièces (unités monde)
+            const float maxErr = maxPoseErr(analytic, baked, m);
+            const AnimClip &clip = lib[m];
+            const Skeleton &sk = analytic.skeleton();
+            std::printf("  %-4s keys=%5d %7.1f KiB  max err %.2e | anim ns/char: analytic %6.1f baked %6.1f"
+                        " | full pose: analytic %6.1f baked %6.1f\n",
+                        names[(int)m], clip.keyCount, clip.bytes() / 1024.0, maxErr,
+                        animNs(sk, nullptr, m, n), animNs(sk, &clip, m, n),
+                        poseNs(analytic, m, n), poseNs(baked, m, n));
+        }
+
+        // Mêmes clips compressés
+        AnimLibrary packedLib = lib;
+        compressLibrary(packedLib);
+        CharacterRenderer packed;
+        packed.setBaked(&packedLib);
+        for (AnimMode m : {AnimMode::Idle, AnimMode::Walk, AnimMode::Jump})
+        {
+            const AnimClip &clip = lib[m];
+            const CompressedClip &z = packedLib.packed[(int)m];
+            std::printf("  %-4s compressed: %d/%d rot + %d/%d trans tracks animated | bytes/clip-s: raw %7.0f"
+                        " packed %6.0f (%.1fx) | decode ns/pose: raw %5.1f packed %5.1f"
+                        " | err vs raw %.2e, vs analytic %.2e\n",
+                        names[(int)m], (int)z.rotTracks.size(), z.jointCount, (int)z.transTracks.size(),
+                        z.jointCount, clip.bytes() / clip.duration, z.bytes() / z.duration,
+                        (double)clip.bytes() / z.bytes(), decodeNs(&clip, nullptr, n), decodeNs(nullptr, &z, n),
+                        maxPoseErr(baked, packed, m), maxPoseErr(analytic, packed, m));
+        }
+        std::printf("  library: raw %.1f KiB, packed %.1f KiB\n", lib.bytes() / 1024.0, packedLib.bytes() / 1024.0);
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+// bench_util.hpp
+#ifndef BENCH_UTIL_HPP
+#define BENCH_UTIL_HPP
+
+// Chronométrage commun aux microbenchmarks de bench/
+#include <algorithm>
+#include <chrono>
+
+// Les boucles mesurées y accumulent un résultat : rien n'est éliminé à la compilation
+static volatile float g_sink;
+
+// Meilleur de 5 passages : la machine de build est partagée
+constexpr int kBenchRuns = 5;
+
+// f() fait ops opérations ; renvoie des ns par opération
+template <class F>
+static double nsPerOp(long ops, F &&f)
+{
+    double best = 1e30;
+    for (int run = 0; run < kBenchRuns; ++run)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / ops);
+    }
+    return best;
+}
+
+// f(r) pour r = 0 .. reps-1 ; renvoie des ms par appel
+template <class F>
+static double msPerRun(int reps, F &&f)
+{
+    double best = 1e30;
+    for (int run = 0; run < kBenchRuns; ++run)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r)
+            f(r);
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count() / reps);
+    }
+    return best;
+}
+
+#endif
@@ -0,0 +1,145 @@
+// crowd_data_bench.cpp
+// Foule variée (CrowdData) de 100k personnages : octets par personnage (SoA +
+// tables partagées vs un enregistrement AoS complet), coût des mises à jour
+// (remplissage, tri, changements de mode) et des poses, comparées à
+// buildCrowdInstances (foule uniforme) et à une boucle AoS personnage par
+// personnage. Headless : aucun contexte GL.
+#include "bench_util.hpp"
+#include "character.hpp"
+#include "crowd.hpp"
+#include "crowd_data.hpp"
+#include "jobs.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Ce qu'on stockerait sans tables : tout par personnage
+struct AoSCharacter {
+    Affine3x4 root;
+    float phase, speed;
+    AnimBlend blend;
+    RigParams rig;
+    RigColors palette;
+    uint8_t skeleton; // squelette construit de rig (cache partagé)
+};
+
+int main(int argc, char **argv)
+{
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+    const int reps = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+
+    CrowdData crowd;
+    CrowdVariety variety;
+    const double msPopulate = msPerRun(1, [&](int) { populateCrowd(crowd, count, variety); });
+    const int parts = crowd.partCount();
+    std::vector<PartInstance> out((size_t)count * parts), ref(out.size());
+
+    std::printf("%d characters, %d parts each, %d rigs x %d palettes, cores=%u\n", count, parts, crowd.rigCount(),
+                crowd.paletteCount(), hw);
+    std::printf("\nmemory per character\n");
+    std::printf("  CrowdData SoA    %4zu B  (+ tables %zu B shared)\n", CrowdData::kBytesPerCharacter,
+                crowd.tableBytes());
+    std::printf("  AoS record       %4zu B  (x%.1f)\n", sizeof(AoSCharacter),
+                (double)sizeof(AoSCharacter) / CrowdData::kBytesPerCharacter);
+    std::printf("  posed parts      %4zu B  (output, %d x PartInstance)\n", parts * sizeof(PartInstance), parts);
+    std::printf("  total %d chars: %.2f MB SoA vs %.2f MB AoS\n", count,
+                (CrowdData::kBytesPerCharacter * (double)count + crowd.tableBytes()) / 1e6,
+                sizeof(AoSCharacter) * (double)count / 1e6);
+
+    // Mises à jour : tri complet, puis 1 % des personnages changent de mode
+    std::printf("\nupdates (ms)\n");
+    std::printf("  populate         %8.3f\n", msPopulate);
+    const double msSort = msPerRun(reps, [&](int)
+                                   {
+        populateCrowd(crowd, count, variety);
+        crowd.sort(); });
+    std::printf("  populate + sort  %8.3f  (%d runs)\n", msSort, crowd.runCount());
+    const int churn = std::max(1, count / 100);
+    int round = 0; // chaque passage change d'autres personnages, vers d'autres modes
+    const double msChurn = msPerRun(reps, [&](int)
+                                    {
+        ++round;
+        for (int k = 0; k < churn; ++k)
+            crowd.setMode((int)(((long)k * 7919 + (long)round * 104729) % count), (AnimMode)((k + round) % 3));
+        crowd.sort(); });
+    std::printf("  1%% setMode + sort %7.3f  (%d changes, %.1f ns/char)\n", msChurn, churn, msChurn * 1e6 / count);
+
+    std::printf("\npose (ms/frame, ns/char)\n");
+    std::vector<unsigned> threadCounts{1u};
+    if (hw > 1)
+        threadCounts.push_back(hw);
+    bool allSame = true;
+    for (unsigned threads : threadCounts)
+    {
+        JobSystem jobs(threads);
+        JobSystem *js = threads > 1 ? &jobs : nullptr;
+
+        populateCrowd(crowd, count, variety);
+        const double msVaried = msPerRun(reps, [&](int r)
+                                         {
+            crowd.pose(r / 60.0f, false, out.data(), js);
+            g_sink = g_sink + out[5].model[1].w; });
+
+        // Même foule variée en AoS : enregistrement complet par personnage,
+        // dans l'ordre d'ajout (rig, mélange et palette changent d'un
+        // personnage au suivant, pas de tri). Un poseBatch par personnage.
+        double msAoS = 0.0;
+        if (threads == 1)
+        {
+            std::vector<AoSCharacter> aos(count);
+            for (int i = 0; i < count; ++i)
+            {
+                const CrowdMember m = crowd.member(i);
+                aos[i] = AoSCharacter{Affine3x4(glm::mat3(1.0f), {m.position.x, 0.0f, m.position.y}), m.phase,
+                                      m.speed, crowd.blend(m.blend), crowd.rig(m.rig).params(),
+                                      crowd.palette(m.palette), m.rig};
+            }
+            std::vector<CharacterRenderer> aosRigs(crowd.rigCount());
+            for (int r = 0; r < crowd.rigCount(); ++r)
+                aosRigs[r].setRig(crowd.rig(r).params());
+            msAoS = msPerRun(reps, [&](int r)
+                             {
+                const float t = r / 60.0f;
+                for (int i = 0; i < count; ++i)
+                {
+                    const AoSCharacter &c = aos[i];
+                    const float tt = t * c.speed + c.phase;
+                    aosRigs[c.skeleton].poseBatch(&tt, 1, c.blend, false, &c.root, out.data() + (size_t)i * parts,
+                                                  &c.palette);
+                }
+                g_sink = g_sink + out[5].model[1].w; });
+        }
+
+        populateCrowd(crowd, count, CrowdVariety{1, 1, false, 0.0f, 0.0f});
+        const double msUniform = msPerRun(reps, [&](int r)
+                                          {
+            crowd.pose(r / 60.0f, false, out.data(), js);
+            g_sink = g_sink + out[5].model[1].w; });
+        const double msBuild = msPerRun(reps, [&](int r)
+                                        {
+            buildCrowdInstances(crowd.rig(0), count, r / 60.0f, AnimMode::Walk, false, ref.data(), js);
+            g_sink = g_sink + ref[5].model[1].w; });
+        const bool same = std::memcmp(out.data(), ref.data(), out.size() * sizeof(PartInstance)) == 0;
+        allSame = allSame && same;
+
+        std::printf("threads=%u\n", threads);
+        std::printf("  varied CrowdData       %8.2f  %6.1f\n", msVaried, msVaried * 1e6 / count);
+        if (threads == 1)
+            std::printf("  varied AoS             %8.2f  %6.1f\n", msAoS, msAoS * 1e6 / count);
+        std::printf("  uniform CrowdData      %8.2f  %6.1f  (identical to buildCrowdInstances: %s)\n", msUniform,
+                    msUniform * 1e6 / count, same ? "yes" : "NO");
+        std::printf("  buildCrowdInstances    %8.2f  %6.1f\n", msBuild, msBuild * 1e6 / count);
+    }
+
+    // Équivalence documentée par populateCrowd : échec du bench si elle casse
+    if (!allSame)
+    {
+        std::fprintf(stderr, "uniform CrowdData differs from buildCrowdInstances\n");
+        return 1;
+    }
+    return 0;
+}
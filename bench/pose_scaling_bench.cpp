@@ -0,0 +1,43 @@
+// pose_scaling_bench.cpp
+// Évaluation des poses d'une foule via JobSystem : personnages/ms selon le
+// nombre de threads (1, 2, 4, 8, N). Headless : aucun contexte GL.
+#include "character.hpp"
+#include "crowd.hpp"
+#include "jobs.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    const int frames = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    CharacterRenderer rig;
+    std::vector<PartInstance> out((size_t)count * rig.partCount());
+
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("characters=%d frames=%d cores=%u\n", count, frames, hw);
+    double base = 0.0;
+    for (unsigned threads : {1u, 2u, 4u, 8u, hw})
+    {
+        JobSystem jobs(threads);
+        for (int f = 0; f < 10; ++f) // chauffe
+            buildCrowdInstances(rig, count, 0.0f, AnimMode::Walk, false, out.data(), &jobs);
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f)
+            buildCrowdInstances(rig, count, f / 60.0f, AnimMode::Walk, false, out.data(), &jobs);
+        auto t1 = std::chrono::steady_clock::now();
+
+        const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count() / frames;
+        const double rate = count / ms;
+        if (base == 0.0)
+            base = rate;
+        std::printf("threads=%-3u  %8.3f ms/frame  %9.1f chars/ms  x%.2f\n", threads, ms, rate, rate / base);
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+// rig_alloc_bench.cpp
+// Allocations par frame et ns par personnage du parcours de la hiérarchie :
+// pile de matrices std::vector reconstruite à chaque draw() (chemin d'avant
+// le Skeleton) vs passe linéaire du Skeleton (CharacterRenderer::pose,
+// buildCrowdInstances) dans un tampon réutilisé. Headless : aucun contexte GL.
+#include "bench_util.hpp"
+#include "character.hpp"
+#include "crowd.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+static size_t g_allocs = 0;
+
+void *operator new(std::size_t sz)
+{
+    ++g_allocs;
+    if (void *p = std::malloc(sz ? sz : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// Pile d'avant (ancien include/MatrixStack.hpp), construite par draw()
+struct VectorMatrixStack {
+    std::vector<glm::mat4> st;
+    VectorMatrixStack() { st.push_back(glm::mat4(1.0f)); }
+    const glm::mat4 &top() const { return st.back(); }
+    void push() { st.push_back(st.back()); }
+    void pop()
+    {
+        if (st.size() > 1)
+            st.pop_back();
+    }
+    void translate(const glm::vec3 &v) { st.back() = glm::translate(st.back(), v); }
+    void rotate(float a, const glm::vec3 &axis) { st.back() = glm::rotate(st.back(), a, axis); }
+    void scale(const glm::vec3 &s) { st.back() = glm::scale(st.back(), s); }
+};
+
+// Un personnage : même séquence push / transform / pop que l'ancien draw()
+// (torse, tête, 2 bras + 2 jambes de deux segments), sans les courbes
+// d'animation : ses ns/char sont un minorant de l'ancien chemin
+static void walkStack(float a)
+{
+    VectorMatrixStack ms;
+    float acc = 0.0f;
+    ms.translate({0.0f, 0.05f, 0.0f});
+    ms.rotate(a, {0, 1, 0});
+    ms.push();
+    for (int part = 0; part < 2; ++part)
+    {
+        ms.push();
+        ms.translate({0.0f, 0.9f, 0.0f});
+        ms.scale({0.7f, 1.4f, 0.4f});
+        acc += ms.top()[3][1];
+        ms.pop();
+    }
+    for (int limb = 0; limb < 4; ++limb)
+    {
+        ms.push();
+        ms.translate({0.5f, 0.5f, 0.0f});
+        ms.rotate(a, {1, 0, 0});
+        for (int seg = 0; seg < 2; ++seg)
+        {
+            ms.push();
+            ms.translate({0.0f, -0.6f, 0.0f});
+            ms.rotate(a * 0.5f, {1, 0, 0});
+            ms.translate({0.0f, -0.3f, 0.0f});
+            ms.scale({0.2f, 0.6f, 0.2f});
+            acc += ms.top()[3][1];
+            ms.pop();
+        }
+        ms.pop();
+    }
+    ms.pop();
+    g_sink = g_sink + acc;
+}
+
+// frame(f) pose une frame de count personnages : allocations par frame (en
+// régime établi, après une frame de chauffe) et ns par personnage
+template <class F>
+static void run(const char *name, int count, int frames, F &&frame)
+{
+    frame(0);
+    const size_t allocs0 = g_allocs;
+    for (int f = 1; f <= frames; ++f)
+        frame(f);
+    const double allocs = (double)(g_allocs - allocs0) / frames;
+    const double ns = nsPerOp((long)count * frames, [&] {
+        for (int f = 1; f <= frames; ++f)
+            frame(f);
+    });
+    std::printf("  %-30s allocs/frame=%9.2f  ns/char=%8.1f\n", name, allocs, ns);
+}
+
+int main(int argc, char **argv)
+{
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000;
+    const int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+
+    CharacterRenderer rig;
+    std::vector<PartInstance> out((size_t)count * rig.partCount());
+    std::printf("characters=%d frames=%d parts/char=%d\n", count, frames, rig.partCount());
+
+    run("MatrixStack (std::vector)", count, frames, [&](int f) {
+        for (int i = 0; i < count; ++i)
+            walkStack(f * 0.001f + i);
+    });
+    run("Skeleton: pose", count, frames, [&](int f) {
+        for (int i = 0; i < count; ++i)
+            rig.pose(f / 60.0f, AnimMode::Walk, false, crowdRoot(i, count), out.data() + (size_t)i * rig.partCount());
+        g_sink = g_sink + out[5].model[1].w;
+    });
+    run("Skeleton: buildCrowdInstances", count, frames, [&](int f) {
+        buildCrowdInstances(rig, count, f / 60.0f, AnimMode::Walk, false, out.data());
+        g_sink = g_sink + out[5].model[1].w;
+    });
+    return 0;
+}
@@ -0,0 +1,156 @@
+// trig_bench.cpp
+// sinBatch / cosBatch (simd_trig.hpp) vs std::sin / std::cos : erreur max
+// par plage d'arguments, ns par valeur, puis courbes d'animation (evalAnim vs evalAnimBatch) et pose
+// complète d'une foule déphasée (pose vs poseBatch).
+#include "bench_util.hpp"
+#include "simd_trig.hpp"
+#include "character.hpp"
+#include "crowd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Erreur absolue max contre sin / cos en double, pour sinBatch / cosBatch et
+// pour std::sin / std::cos en float ; écarts bit à bit entre le noyau SIMD et
+// le noyau scalaire
+static void accuracy(float lo, float hi, bool cosine)
+{
+    const size_t n = 1 << 21;
+    std::vector<float> x(n), s(n);
+    for (size_t i = 0; i < n; ++i)
+        x[i] = lo + (hi - lo) * ((float)i / (float)n);
+    (cosine ? cosBatch : sinBatch)(x.data(), s.data(), n);
+    double errBatch = 0.0, errStd = 0.0;
+    size_t mismatch = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double ref = cosine ? std::cos((double)x[i]) : std::sin((double)x[i]);
+        errBatch = std::max(errBatch, std::fabs(s[i] - ref));
+        errStd = std::max(errStd, std::fabs((cosine ? std::cos(x[i]) : std::sin(x[i])) - ref));
+        const float a = cosine ? cosApprox(x[i]) : sinApprox(x[i]);
+        mismatch += std::memcmp(&a, &s[i], sizeof(float)) != 0;
+    }
+    std::printf("  [%8.0f, %8.0f]  max |err|: %s %.2e  std::%s(float) %.2e  simd != scalar: %zu\n", lo, hi,
+                cosine ? "cosBatch" : "sinBatch", errBatch, cosine ? "cos" : "sin", errStd, mismatch);
+}
+
+int main(int argc, char **argv)
+{
+    const int reps = argc > 1 ? std::atoi(argv[1]) : 2000;
+    std::printf("kernel: %s\n", trigIsa());
+
+    for (bool cosine : {false, true})
+    {
+        std::printf("accuracy (2M points per range, reference: double %s):\n", cosine ? "cos" : "sin");
+        accuracy(-3.14159265f, 3.14159265f, cosine);
+        accuracy(-100.0f, 100.0f, cosine);
+        accuracy(0.0f, 8192.0f, cosine);
+        accuracy(8192.0f, 65536.0f, cosine);
+    }
+
+    // Débit sur un tableau qui tient en L1
+    const int n = 1024;
+    std::vector<float> x(n), s(n);
+    for (int i = 0; i < n; ++i)
+        x[i] = 0.0137f * i - 5.0f;
+    const long ops = (long)reps * n;
+    const double nsStd = nsPerOp(ops, [&]
+                                 {
+        for (int r = 0; r < reps; ++r)
+        {
+            for (int i = 0; i < n; ++i)
+                s[i] = std::sin(x[i]);
+            g_sink = g_sink + s[r & (n - 1)];
+        } });
+    const double nsScalar = nsPerOp(ops, [&]
+                                    {
+        for (int r = 0; r < reps; ++r)
+        {
+            for (int i = 0; i < n; ++i)
+                s[i] = sinApprox(x[i]);
+            g_sink = g_sink + s[r & (n - 1)];
+        } });
+    const double nsBatch = nsPerOp(ops, [&]
+                                   {
+        for (int r = 0; r < reps; ++r)
+        {
+            sinBatch(x.data(), s.data(), n);
+            g_sink = g_sink + s[r & (n - 1)];
+        } });
+    std::printf("sin      ns/value: std::sin %6.2f  scalar %6.2f  %s %6.2f  x%.1f\n", nsStd, nsScalar, trigIsa(),
+                nsBatch, nsStd / nsBatch);
+    const double nsStdCos = nsPerOp(ops, [&]
+                                    {
+        for (int r = 0; r < reps; ++r)
+        {
+            for (int i = 0; i < n; ++i)
+                s[i] = std::cos(x[i]);
+            g_sink = g_sink + s[r & (n - 1)];
+        } });
+    const double nsCos = nsPerOp(ops, [&]
+                                 {
+        for (int r = 0; r < reps; ++r)
+        {
+            cosBatch(x.data(), s.data(), n);
+            g_sink = g_sink + s[r & (n - 1)];
+        } });
+    std::printf("cos      ns/value: std::cos %6.2f  %s %6.2f  x%.1f\n", nsStdCos, trigIsa(), nsCos, nsStdCos / nsCos);
+
+    // Courbes d'une foule déphasée (phases réparties sur 3 s), par personnage
+    const int chars = 1024;
+    std::vector<float> t(chars);
+    std::vector<AnimChannels> a(chars), b(chars);
+    for (int i = 0; i < chars; ++i)
+        t[i] = 12.5f + 3.0f * i / chars;
+    const long evals = (long)reps * chars;
+    for (AnimMode mode : {AnimMode::Walk, AnimMode::Jump})
+    {
+        const double nsOne = nsPerOp(evals, [&]
+                                     {
+            for (int r = 0; r < reps; ++r)
+            {
+                for (int i = 0; i < chars; ++i)
+                    a[i] = evalAnim(mode, t[i]);
+                g_sink = g_sink + a[r & (chars - 1)][ChSway];
+            } });
+        const double nsBatchCh = nsPerOp(evals, [&]
+                                         {
+            for (int r = 0; r < reps; ++r)
+            {
+                evalAnimBatch(mode, t.data(), chars, b.data());
+                g_sink = g_sink + b[r & (chars - 1)][ChSway];
+            } });
+        float err = 0.0f;
+        for (int i = 0; i < chars; ++i)
+            for (int c = 0; c < ChCount; ++c)
+                err = std::max(err, std::fabs(a[i][c] - b[i][c]));
+        std::printf("%s curves ns/char: evalAnim %6.2f  evalAnimBatch %6.2f  x%.1f  (max channel diff %.1e)\n",
+                    mode == AnimMode::Walk ? "walk" : "jump", nsOne, nsBatchCh, nsOne / nsBatchCh, err);
+    }
+
+    // Pose complète (courbes + squelette + pièces), walk
+    CharacterRenderer rig;
+    std::vector<Affine3x4> roots(chars);
+    for (int i = 0; i < chars; ++i)
+        roots[i] = crowdRoot(i, chars);
+    std::vector<PartInstance> out((size_t)chars * rig.partCount());
+    const int poseReps = std::max(1, reps / 10);
+    const long poses = (long)poseReps * chars;
+    const double nsPose = nsPerOp(poses, [&]
+                                  {
+        for (int r = 0; r < poseReps; ++r)
+            for (int i = 0; i < chars; ++i)
+                rig.pose(t[i], AnimMode::Walk, false, roots[i], &out[(size_t)i * rig.partCount()]);
+        g_sink = g_sink + out[5].model[1].w; });
+    const double nsPoseBatch = nsPerOp(poses, [&]
+                                       {
+        for (int r = 0; r < poseReps; ++r)
+            rig.poseBatch(t.data(), chars, AnimMode::Walk, false, roots.data(), out.data());
+        g_sink = g_sink + out[5].model[1].w; });
+    std::printf("walk pose   ns/char: pose %6.1f  poseBatch %6.1f  x%.2f\n", nsPose, nsPoseBatch,
+                nsPose / nsPoseBatch);
+    return 0;
+}
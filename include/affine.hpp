@@ -0,0 +1,194 @@
+// affine.hpp
+#ifndef AFFINE_HPP
+#define AFFINE_HPP
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(AFFINE_SCALAR)
+#define AFFINE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+// Transformation affine stockée par lignes : row[i] = (ligne i de la partie
+// linéaire, translation i). La ligne (0 0 0 1) d'une mat4 affine n'est ni
+// stockée ni multipliée : 48 octets au lieu de 64, et une composition coûte
+// 3 lignes × 3 multiply-add de vec4 au lieu de 4 colonnes × 4.
+// Même mémoire qu'un mat3x4 GLSL (3 colonnes vec4) : envoyée telle quelle
+// (glUniformMatrix3x4fv sans transposition, ou 3 attributs d'instance) et
+// appliquée côté shader par vec4(p, 1.0) * M.
+struct alignas(16) Affine3x4 {
+    glm::vec4 row[3];
+
+    Affine3x4() : row{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}} {}
+    Affine3x4(const glm::vec4& r0, const glm::vec4& r1, const glm::vec4& r2) : row{r0, r1, r2} {}
+    // Partie linéaire R (colonnes glm) + translation t
+    explicit Affine3x4(const glm::mat3& R, const glm::vec3& t = glm::vec3(0.0f))
+        : row{{R[0][0], R[1][0], R[2][0], t.x}, {R[0][1], R[1][1], R[2][1], t.y}, {R[0][2], R[1][2], R[2][2], t.z}} {}
+    // m supposée affine : sa dernière ligne est ignorée
+    explicit Affine3x4(const glm::mat4& m)
+        : row{{m[0][0], m[1][0], m[2][0], m[3][0]}, {m[0][1], m[1][1], m[2][1], m[3][1]},
+              {m[0][2], m[1][2], m[2][2], m[3][2]}} {}
+
+    glm::mat4 toMat4() const
+    {
+        glm::mat4 m(1.0f);
+        for (int c = 0; c < 4; ++c)
+            m[c] = glm::vec4(row[0][c], row[1][c], row[2][c], c == 3 ? 1.0f : 0.0f);
+        return m;
+    }
+
+    glm::vec4&       operator[](int i)       { return row[i]; }
+    const glm::vec4& operator[](int i) const { return row[i]; }
+
+    // Image de l'axe c (colonne c de la partie linéaire) ; c = 3 : translation
+    glm::vec3 column(int c) const { return {row[0][c], row[1][c], row[2][c]}; }
+    glm::vec3 translation() const { return column(3); }
+};
+
+// a * B où B a pour lignes b0, b1, b2 (4e ligne 0 0 0 1) : chaque ligne de a
+// combine celles de B, row[i] = a[i].x * b0 + a[i].y * b1 + a[i].z * b2 + (0, 0, 0, a[i].w).
+// Que des opérations verticales sur des lignes entières : 1 registre SSE par ligne.
+// Les lignes sont passées par valeur pour que B, souvent construit à la volée
+// (translation, rotation), reste en registres au lieu d'être relu en mémoire.
+inline Affine3x4 composeRows(const Affine3x4& a, const glm::vec4& b0, const glm::vec4& b1, const glm::vec4& b2)
+{
+    Affine3x4 r;
+#ifdef AFFINE_SSE
+    const __m128 B0 = _mm_setr_ps(b0.x, b0.y, b0.z, b0.w), B1 = _mm_setr_ps(b1.x, b1.y, b1.z, b1.w),
+                 B2 = _mm_setr_ps(b2.x, b2.y, b2.z, b2.w), E3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    for (int i = 0; i < 3; ++i)
+    {
+        const __m128 l = _mm_load_ps(&a.row[i].x);
+        __m128 v = _mm_mul_ps(B0, _mm_shuffle_ps(l, l, _MM_SHUFFLE(0, 0, 0, 0)));
+        v = _mm_add_ps(v, _mm_mul_ps(B1, _mm_shuffle_ps(l, l, _MM_SHUFFLE(1, 1, 1, 1))));
+        v = _mm_add_ps(v, _mm_mul_ps(B2, _mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 2, 2, 2))));
+        v = _mm_add_ps(v, _mm_mul_ps(E3, _mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_store_ps(&r.row[i].x, v);
+    }
+#else
+    for (int i = 0; i < 3; ++i)
+    {
+        const glm::vec4& l = a.row[i];
+        r.row[i] = b0 * l.x + b1 * l.y + b2 * l.z + glm::vec4(0.0f, 0.0f, 0.0f, l.w);
+    }
+#endif
+    return r;
+}
+
+// a * b (b appliquée d'abord)
+inline Affine3x4 operator*(const Affine3x4& a, const Affine3x4& b)
+{
+    return composeRows(a, b.row[0], b.row[1], b.row[2]);
+}
+
+inline glm::vec3 transformPoint(const Affine3x4& a, const glm::vec3& p)
+{
+    const glm::vec4 h(p, 1.0f);
+    return {glm::dot(a.row[0], h), glm::dot(a.row[1], h), glm::dot(a.row[2], h)};
+}
+
+inline glm::vec3 transformVector(const Affine3x4& a, const glm::vec3& v)
+{
+    const glm::vec4 h(v, 0.0f);
+    return {glm::dot(a.row[0], h), glm::dot(a.row[1], h), glm::dot(a.row[2], h)};
+}
+
+// Déterminant de la partie linéaire (< 0 : repère miroir)
+inline float determinant(const Affine3x4& a)
+{
+    return glm::dot(glm::cross(a.column(0), a.column(1)), a.column(2));
+}
+
+// Inverse exacte d'une affine inversible : L⁻¹ par cofacteurs, t' = -L⁻¹ t
+inline Affine3x4 inverse(const Affine3x4& a)
+{
+    const glm::vec3 c0 = a.column(0), c1 = a.column(1), c2 = a.column(2), t = a.translation();
+    // Lignes de L⁻¹ = produits vectoriels des colonnes de L / det
+    const glm::vec3 r0 = glm::cross(c1, c2), r1 = glm::cross(c2, c0), r2 = glm::cross(c0, c1);
+    const float inv = 1.0f / glm::dot(c0, r0);
+    return Affine3x4(glm::vec4(r0 * inv, -glm::dot(r0, t) * inv), glm::vec4(r1 * inv, -glm::dot(r1, t) * inv),
+                     glm::vec4(r2 * inv, -glm::dot(r2, t) * inv));
+}
+
+// ---------------------- Constructions en repère local (comme glm::translate / rotate / scale) ----------------------
+
+// a * T(v) * S(s) : row[i] = row[i] * (s, 1), puis row[i].w += dot(row[i].xyz, v).
+// En SSE, les 3 produits scalaires sont sommés après transposition (pas de
+// somme horizontale ligne par ligne).
+inline Affine3x4 translateScale(const Affine3x4& a, const glm::vec3& v, const glm::vec3& s)
+{
+    Affine3x4 r;
+#ifdef AFFINE_SSE
+    const __m128 V = _mm_setr_ps(v.x, v.y, v.z, 0.0f), K = _mm_setr_ps(s.x, s.y, s.z, 1.0f);
+    const __m128 zero = _mm_setzero_ps(), e3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    const __m128 l0 = _mm_load_ps(&a.row[0].x), l1 = _mm_load_ps(&a.row[1].x), l2 = _mm_load_ps(&a.row[2].x);
+    const __m128 p0 = _mm_mul_ps(l0, V), p1 = _mm_mul_ps(l1, V), p2 = _mm_mul_ps(l2, V);
+    const __m128 lo01 = _mm_unpacklo_ps(p0, p1), hi01 = _mm_unpackhi_ps(p0, p1);
+    const __m128 lo2 = _mm_unpacklo_ps(p2, zero), hi2 = _mm_unpackhi_ps(p2, zero);
+    // d = (dot0, dot1, dot2, 0) = colonnes x + y + z des produits
+    const __m128 d = _mm_add_ps(_mm_add_ps(_mm_movelh_ps(lo01, lo2), _mm_movehl_ps(lo2, lo01)),
+                                _mm_movelh_ps(hi01, hi2));
+    _mm_store_ps(&r.row[0].x,
+                 _mm_add_ps(_mm_mul_ps(l0, K), _mm_mul_ps(e3, _mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 0, 0, 0)))));
+    _mm_store_ps(&r.row[1].x,
+                 _mm_add_ps(_mm_mul_ps(l1, K), _mm_mul_ps(e3, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1)))));
+    _mm_store_ps(&r.row[2].x,
+                 _mm_add_ps(_mm_mul_ps(l2, K), _mm_mul_ps(e3, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 2, 2)))));
+#else
+    const glm::vec4 k(s, 1.0f);
+    for (int i = 0; i < 3; ++i)
+    {
+        r.row[i] = a.row[i] * k;
+        r.row[i].w += glm::dot(glm::vec3(a.row[i]), v);
+    }
+#endif
+    return r;
+}
+
+// a * T(v) : seule la translation change
+inline Affine3x4 translate(const Affine3x4& a, const glm::vec3& v)
+{
+    return translateScale(a, v, glm::vec3(1.0f));
+}
+
+// a * S(s)
+inline Affine3x4 scale(const Affine3x4& a, const glm::vec3& s)
+{
+#ifdef AFFINE_SSE
+    Affine3x4 r;
+    const __m128 k = _mm_setr_ps(s.x, s.y, s.z, 1.0f);
+    for (int i = 0; i < 3; ++i)
+        _mm_store_ps(&r.row[i].x, _mm_mul_ps(_mm_load_ps(&a.row[i].x), k));
+    return r;
+#else
+    const glm::vec4 k(s, 1.0f);
+    return Affine3x4(a.row[0] * k, a.row[1] * k, a.row[2] * k);
+#endif
+}
+
+// a * T(t) * R : articulation complète en une seule composition (R en colonnes glm,
+// ex. mat3_cast d'un quaternion)
+inline Affine3x4 translateRotate(const Affine3x4& a, const glm::vec3& t, const glm::mat3& R)
+{
+    return composeRows(a, {R[0][0], R[1][0], R[2][0], t.x}, {R[0][1], R[1][1], R[2][1], t.y},
+                       {R[0][2], R[1][2], R[2][2], t.z});
+}
+
+// Idem avec R(angle, axis), angle en radians : mêmes termes que glm::rotate, écrits par lignes
+inline Affine3x4 translateRotate(const Affine3x4& a, const glm::vec3& t, float angle, const glm::vec3& axis)
+{
+    const float c = std::cos(angle), s = std::sin(angle);
+    const glm::vec3 n = glm::normalize(axis);
+    const glm::vec3 k = n * (1.0f - c);
+    return composeRows(a, {c + k.x * n.x, k.y * n.x - s * n.z, k.z * n.x + s * n.y, t.x},
+                       {k.x * n.y + s * n.z, c + k.y * n.y, k.z * n.y - s * n.x, t.y},
+                       {k.x * n.z - s * n.y, k.y * n.z + s * n.x, c + k.z * n.z, t.z});
+}
+
+inline Affine3x4 rotate(const Affine3x4& a, float angle, const glm::vec3& axis)
+{
+    return translateRotate(a, glm::vec3(0.0f), angle, axis);
+}
+
+#endif // AFFINE_HPP
@@ -0,0 +1,96 @@
+// anim_clip.hpp
+#ifndef ANIM_CLIP_HPP
+#define ANIM_CLIP_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+#include "character.hpp"
+
+// Clip "cuit" : à chaque clé, rotation locale de chaque articulation et
+// translation animée (ajoutée à l'offset de bind du squelette). Ne dépend pas
+// des tailles (RigParams), seulement de la topologie / des axes du squelette.
+// Stockage clé-majeur : key * jointCount + joint.
+struct AnimClip {
+    float rate = 30.0f;     // clés par seconde
+    float duration = 0.0f;  // période exacte des courbes (le clip boucle)
+    int jointCount = 0;
+    int keyCount = 0;       // clé keyCount ≡ clé 0
+    std::vector<glm::quat> rot;
+    std::vector<glm::vec3> trans;
+
+    size_t bytes() const { return rot.size() * sizeof(glm::quat) + trans.size() * sizeof(glm::vec3); }
+};
+
+// Période commune des courbes de evalAnim (pas + oscillation du torse)
+float animPeriod(AnimMode mode);
+
+// Échantillonne evalAnim(mode) à `rate` clés/s sur une période
+AnimClip bakeClip(const Skeleton& s, AnimMode mode, float rate);
+
+// Pose locale à l'instant t (bouclé) : lookup des 2 clés + lerp / nlerp
+void sampleClip(const AnimClip& c, float t, glm::quat* rot, glm::vec3* trans);
+
+// ---------------------- Clips compressés ----------------------
+
+// Même clip, compact (cf. compressClip) :
+//  - pistes constantes (articulations sans canal, translations nulles) sorties
+//    du flux : une seule valeur chacune ;
+//  - rotations animées en 48 bits "smallest three" : indice de la plus grande
+//    composante (2 bits, rendue positive) + les 3 autres sur 15 bits dans
+//    [-1/√2, 1/√2] (pas ~4.3e-5) ;
+//  - translations animées ramenées à [min, max] de la piste, 16 bits par composante.
+// Flux clé-majeur : une clé = rotTracks × 3 mots puis transTracks × 3 mots,
+// les deux clés d'un échantillon sont lues d'un bloc, dans l'ordre.
+struct CompressedClip {
+    float rate = 30.0f;
+    float duration = 0.0f;
+    int jointCount = 0;
+    int keyCount = 0;
+    glm::quat constRot[kMaxJoints];   // valeur des pistes constantes (écrasée pour les animées)
+    glm::vec3 constTrans[kMaxJoints];
+    std::vector<uint8_t> rotTracks, transTracks; // articulations animées, dans l'ordre du flux
+    std::vector<glm::vec3> transMin, transStep;  // par piste de translation animée
+    std::vector<uint16_t> keys;
+
+    int keyWords() const { return 3 * (int)(rotTracks.size() + transTracks.size()); }
+    size_t bytes() const
+    {
+        return keys.size() * sizeof(uint16_t) + (rotTracks.size() + transTracks.size()) * sizeof(uint8_t) +
+               (transMin.size() + transStep.size()) * sizeof(glm::vec3) +
+               jointCount * (sizeof(glm::quat) + sizeof(glm::vec3));
+    }
+};
+
+CompressedClip compressClip(const AnimClip& c);
+
+// Comme sampleClip : constantes copiées, puis une passe sur les pistes
+// animées des 2 clés (décodage + nlerp / lerp)
+void sampleCompressed(const CompressedClip& c, float t, glm::quat* rot, glm::vec3* trans);
+
+// Un clip par AnimMode, brut ou compressé (compressLibrary)
+struct AnimLibrary {
+    AnimClip clips[3];
+    CompressedClip packed[3];
+    bool compressed = false; // échantillonner packed (clips est alors vidé)
+    const AnimClip& operator[](AnimMode m) const { return clips[(int)m]; }
+
+    size_t bytes() const;
+};
+
+void bakeLibrary(const Skeleton& s, float rate, AnimLibrary& out);
+
+// Remplace les clips bruts par leur version compressée
+void compressLibrary(AnimLibrary& lib);
+
+// sampleClip ou sampleCompressed selon lib.compressed
+void sampleLibrary(const AnimLibrary& lib, AnimMode mode, float t, glm::quat* rot, glm::vec3* trans);
+
+// Pose locale mélangée (cf. AnimBlend) : nlerp pondéré des rotations, somme
+// pondérée des translations ; une couche multiplie la rotation des
+// articulations dont le canal est dans son masque par sa rotation × weight.
+void sampleBlend(const AnimLibrary& lib, const Skeleton& s, const AnimBlend& b, float t, glm::quat* rot,
+                 glm::vec3* trans);
+
+#endif // ANIM_CLIP_HPP
@@ -0,0 +1,78 @@
+// anim_graph.hpp
+#ifndef ANIM_GRAPH_HPP
+#define ANIM_GRAPH_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "character.hpp"
+
+// Un état du graphe : un clip joué à sa vitesse
+struct AnimState {
+    std::string name;
+    AnimSource source;
+};
+
+// États nommés et durées des fondus entre eux. Les 3 premiers états sont
+// Idle, Walk et Jump (indice = AnimMode) ; addState en ajoute d'autres
+// (ex. "run" = Walk × 1.8).
+class AnimGraph {
+public:
+    AnimGraph();
+
+    // Indice du nouvel état
+    int addState(const std::string& name, const AnimSource& source);
+    int find(const std::string& name) const; // -1 si absent
+    const AnimState& state(int i) const { return states_[i]; }
+    int stateCount() const { return (int)states_.size(); }
+
+    // Durée du fondu from → to ; from = -1 : depuis n'importe quel état
+    void setFade(int from, int to, float seconds);
+    float fade(int from, int to) const; // sinon defaultFade
+
+    float defaultFade = 0.3f; // secondes
+
+private:
+    struct Fade {
+        int from, to;
+        float seconds;
+    };
+    std::vector<AnimState> states_;
+    std::vector<Fade> fades_;
+};
+
+// Lecture d'un graphe par une foule : pile de fondus enchaînés. play()
+// empile l'état cible, dont le poids monte de 0 à 1 (smoothstep) sur la durée
+// du fondu ; le reste revient à la pile en dessous, récursivement. Un
+// changement en plein fondu mélange donc jusqu'à kMaxBlend états.
+// blend(t) ne dépend que de t et des play() passés (pas fixes, t - dt).
+class AnimPlayer {
+public:
+    explicit AnimPlayer(const AnimGraph& graph, int state = (int)AnimMode::Walk);
+
+    // Fondu vers `state` à partir de t ; sans effet si c'est déjà la cible
+    void play(int state, float t);
+    int state() const { return stack_[depth_ - 1].state; } // état cible
+
+    // Couche additive `slot` (< kMaxLayers) : canaux `mask` de l'état × weight ; weight 0 : retirée
+    void setLayer(int slot, int state, float weight, uint32_t mask);
+
+    AnimBlend blend(float t) const;
+
+private:
+    struct Entry {
+        int state;
+        float start, duration;
+    };
+    // Poids de l'entrée i dans ce qui reste sous les entrées au-dessus (0..1)
+    float coverage(int i, float t) const;
+
+    const AnimGraph* graph_;
+    Entry stack_[kMaxBlend];
+    int depth_ = 0;
+    int layerState_[kMaxLayers] = {};
+    float layerWeight_[kMaxLayers] = {};
+    uint32_t layerMask_[kMaxLayers] = {};
+};
+
+#endif // ANIM_GRAPH_HPP
@@ -0,0 +1,87 @@
+// bench.hpp
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <string>
+#include "character.hpp"
+#include "frame_capture.hpp"
+#include "scene.hpp"
+
+// Mode --bench : contexte hors écran, nombre de frames fixe, horloge
+// déterministe (frame / 60 s) au lieu de glfwGetTime().
+//
+//   humangl --bench [--frames N] [--warmup N] [--mode idle|walk|jump[+...]]
+//           [--count N] [--size WxH] [--instanced] [--threads N] [--json FILE|-]
+//           [--shader-cache DIR|off] [--baked HZ] [--compressed] [--cube buffered|procedural]
+//           [--raster gl|soft] [--ppm FILE] [--validate PCT] [--render-thread]
+//           [--no-cull] [--camera N] [--lod] [--paused] [--tbo] [--variety] [--profile FILE]
+//           [--capture PATTERN | --capture-pipe CMD] [--capture-depth N] [--capture-drop]
+//
+// --instanced, --tbo, --cube, --render-thread, --no-cull, --paused, --variety,
+// --profile et --capture* s'appliquent aussi au mode fenêtré (--paused :
+// démarre en pause ; capture : chaque image dessinée, à la taille initiale).
+// --render-thread : poses sur un thread de simulation, GL sur un autre,
+// instantanés échangés par triple buffer (latence / débit comparables).
+// --no-cull : tous les personnages posés et dessinés (sans CrowdCuller).
+// --camera N : caméra cadrée pour une foule de N personnages (défaut --count) ;
+// N < --count rapproche la caméra, une partie de la foule sort du champ.
+// --compressed : avec --baked, clips compressés (compressLibrary) au lieu des bruts.
+// --tbo : chemin instancié (implique --instanced) avec les pièces en texture
+// buffer au lieu des attributs d'instance (cf. CrowdRenderer::setTextureBuffer).
+// --lod : niveaux de détail de l'animation (CrowdLod), boucle GL à un thread
+// seulement : ignoré (avec un avertissement) par --render-thread, --raster
+// soft et la fenêtre, qui interpolent ou dessinent des poses complètes.
+// --variety : foule variée de populateCrowd (CrowdData : tailles, palettes,
+// mélanges, phases et vitesses par personnage), posée entière puis filtrée
+// (renderParts) ; les marcheurs suivent --mode. Courbes analytiques (pas de
+// --baked), --lod ignoré.
+// --paused : animation en pause ; en GL, comme dans la fenêtre, une frame de
+// même pose que l'image affichée n'est pas redessinée (cf. PoseKey). Le temps CPU du
+// processus par frame mesure ce que coûte une scène figée.
+// --mode walk+jump : mélange à poids égaux (evalBlendBatch), jusqu'à kMaxBlend.
+// --profile : zones CPU / GPU (profiler.hpp) des frames mesurées, moyennes
+// par zone et trace Chrome dans FILE (fenêtre : écrite à la fermeture).
+// Seulement avec un build make PROFILE=1.
+// --capture : frames mesurées lues par PBO (FrameCapture) et écrites par un
+// thread writer, séquence PATTERN (ex. out/f_%05d.png) ou RGBA brut sur
+// l'entrée de CMD ; --capture-depth 0 : glReadPixels synchrone (référence) ;
+// --capture-drop : frame perdue plutôt qu'attendre un writer en retard.
+// --json : stats en JSON dans FILE ; "-" : JSON seul sur stdout, rapport
+// texte sur stderr (stdout reste lisible par un parseur JSON).
+// --raster soft : rasteriseur CPU (soft_raster.hpp), aucun contexte GL.
+// --ppm : écrit la dernière frame. --validate : rend la dernière frame en GL
+// et en logiciel, échoue si plus de PCT % des pixels diffèrent.
+struct BenchOptions {
+    bool enabled = false;
+    int frames = 300;
+    int warmup = 30;
+    AnimBlend mode = AnimMode::Walk;
+    int count = 1;
+    int cameraCount = 0; // 0 = count
+    int width = 800, height = 600;
+    bool instanced = false;
+    bool tbo = false;
+    bool renderThread = false;
+    bool culling = true;
+    bool lod = false;
+    bool paused = false;
+    bool variety = false;
+    int threads = 0;  // JobSystem (0 = un par cœur)
+    bool proceduralCube = false;
+    bool softRaster = false;
+    float validate = -1.0f; // < 0 : pas de validation
+    std::string ppm;
+    float bakedRate = 0.0f; // > 0 : clips cuits à cette fréquence au lieu des courbes
+    bool compressed = false; // clips cuits compressés (cf. CompressedClip)
+    std::string json; // vide = pas de JSON, "-" = stdout (rapport texte sur stderr)
+    std::string profile; // trace Chrome (vide = pas de capture)
+    CaptureOptions capture;
+    std::string shaderCache = kShaderCacheDir; // "off" = compilation source
+};
+
+// false si un argument est invalide (message sur stderr)
+bool parseBenchArgs(int argc, char** argv, BenchOptions& out);
+
+int runBench(const BenchOptions& opt);
+
+#endif // BENCH_HPP
@@ -4,7 +4,12 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include "MatrixStack.hpp"
+#include <cstdint>
+#include "affine.hpp"
+#include "skeleton.hpp"
+
+struct AnimLibrary;
+class CommandBuffer;
 
 // Ta config "taille" (comme avant)
 struct RigParams {
@@ -23,41 +28,177 @@ struct RigColors {
     glm::vec4 leg   {0.9f, 0.6f, 0.6f, 1.0f};
 };
 
+// Comparaisons champ à champ (cf. CharacterRenderer::revision)
+inline bool operator==(const RigParams& a, const RigParams& b) {
+    return a.torsoH == b.torsoH && a.torsoW == b.torsoW && a.torsoD == b.torsoD && a.headH == b.headH &&
+           a.upperArmL == b.upperArmL && a.foreArmL == b.foreArmL && a.armR == b.armR &&
+           a.thighL == b.thighL && a.shinL == b.shinL && a.legR == b.legR;
+}
+inline bool operator!=(const RigParams& a, const RigParams& b) { return !(a == b); }
+inline bool operator==(const RigColors& a, const RigColors& b) {
+    return a.head == b.head && a.torso == b.torso && a.arm == b.arm && a.leg == b.leg;
+}
+inline bool operator!=(const RigColors& a, const RigColors& b) { return !(a == b); }
+
 enum class AnimMode { Idle, Walk, Jump };
 
+// Un clip joué à sa propre vitesse (états définis par l'utilisateur, cf. AnimGraph)
+struct AnimSource {
+    AnimMode clip = AnimMode::Idle;
+    float speed = 1.0f; // temps du clip = speed × temps du personnage
+};
+
+constexpr int kMaxBlend = 4;  // sources mélangées à la fois
+constexpr int kMaxLayers = 2; // couches additives
+
+// Couche additive : canaux de `source` retenus par `mask` (bits AnimChannel)
+// ajoutés × weight à la pose mélangée. ChBounce n'est jamais ajouté : le
+// rebond reste ≤ kMaxAnimTranslation (sphères englobantes).
+struct AnimLayer {
+    AnimSource source;
+    float weight = 0.0f;
+    uint32_t mask = 0;
+};
+
+// Pose demandée : somme des `count` sources pondérées (poids de somme 1),
+// puis couches additives. Toutes les fonctions de pose la prennent ; un
+// AnimMode s'y convertit implicitement (une source, poids 1).
+struct AnimBlend {
+    int count = 1;
+    AnimSource source[kMaxBlend];
+    float weight[kMaxBlend] = {1.0f};
+    int layers = 0;
+    AnimLayer layer[kMaxLayers];
+
+    AnimBlend() = default;
+    AnimBlend(AnimMode m) { source[0].clip = m; }
+};
+
+// Entrées utilisées seulement (cf. PoseKey)
+bool operator==(const AnimBlend& a, const AnimBlend& b);
+inline bool operator!=(const AnimBlend& a, const AnimBlend& b) { return !(a == b); }
+
+// Une pièce posée : transformation monde du cube unité + couleur (64 octets).
+// Layout utilisé tel quel comme attribut d'instance (cf. CrowdRenderer).
+struct PartInstance {
+    Affine3x4 model;
+    glm::vec4 color;
+};
+
+// Courbes analytiques de chaque mode → valeurs des canaux du squelette
+AnimChannels evalAnim(AnimMode mode, float t);
+
+// Plus grande valeur absolue d'un canal de translation (ChBounce, saut) :
+// borne des sphères englobantes (cf. CharacterRenderer::boundRadius)
+constexpr float kMaxAnimTranslation = 0.25f;
+
+// Personnages évalués ensemble par evalAnimBatch / poseBatch
+constexpr int kAnimBatch = 16;
+
+// Mêmes courbes pour n instants t[i] (un par personnage, tableau SoA) :
+// sinus par lots de kAnimBatch via sinBatch (simd_trig.hpp), au lieu de 3
+// std::sin par personnage. Écart à evalAnim ≤ ~1e-7 par canal.
+void evalAnimBatch(AnimMode mode, const float* t, int n, AnimChannels* out);
+
+// Pose mélangée d'un personnage : evalAnim de chaque source, même somme
+AnimChannels evalBlend(const AnimBlend& b, float t);
+
+// Canaux de kAnimBatch personnages en SoA : v[canal][personnage]
+struct ChannelBatch {
+    alignas(16) float v[ChCount][kAnimBatch];
+};
+
+// Mélange pour n instants, par blocs de kAnimBatch : chaque source (courbes
+// de evalAnimBatch) est accumulée × poids dans un ChannelBatch, puis le bloc
+// est transposé dans out. Poids communs au bloc : sommer N poses sur M
+// personnages ne teste rien par personnage. Une seule source : comme evalAnimBatch.
+void evalBlendBatch(const AnimBlend& b, const float* t, int n, AnimChannels* out);
+
+// Couleur d'un emplacement de palette (ColorSlot)
+const glm::vec4& slotColor(const RigColors& c, int slot);
+
 // Renderer orienté "une pièce = un seul draw d’un cube 1×1×1"
-// conforme aux contraintes du sujet. 
+// conforme aux contraintes du sujet. Sans GL : il pose le squelette et
+// enregistre les draws dans un CommandBuffer (cf. command_buffer.hpp),
+// exécuté ensuite par un backend.
 class CharacterRenderer {
 public:
-    CharacterRenderer(GLint uModel, GLint uColor, GLuint cubeVAO)
-        : uModel_(uModel), uColor_(uColor), cubeVAO_(cubeVAO) {}
+    CharacterRenderer() { rebuild(); }
+
+    // Sans effet si rien ne change (appelables à chaque frame)
+    void setRig(const RigParams& p)   { if (p != P_) { P_ = p; rebuild(); } }
+    void setColors(const RigColors& c){ if (c != C_) { C_ = c; ++revision_; } }
+    // Clips cuits (cf. anim_clip.hpp) au lieu des courbes analytiques ; nullptr = analytique
+    void setBaked(const AnimLibrary* lib) { if (lib != baked_) { baked_ = lib; ++revision_; } }
+
+    // Incrémentée à chaque changement effectif de setRig / setColors /
+    // setBaked : deux poses de même révision, mode et temps sont identiques
+    // (cf. CrowdPoseCache)
+    uint32_t revision() const { return revision_; }
 
-    void setRig(const RigParams& p)   { P_ = p; }
-    void setColors(const RigColors& c){ C_ = c; }
+    // Palette dans cmds (une fois par frame, avant record) ; renvoie le
+    // premier matériau, à passer à record()
+    uint16_t recordMaterials(CommandBuffer& cmds) const;
 
-    // Appel par frame
-    void draw(float t, AnimMode mode, bool paused);
+    // n pièces posées (pose() / buildCrowdInstances, personnages à la suite)
+    // → une commande par pièce, écrites à partir de `first` (plage réservée
+    // par cmds.allocate). Plages disjointes : appelable depuis plusieurs threads.
+    // partIndex : indice dans le squelette de chaque pièce quand parts a été
+    // filtré (cf. CrowdCuller) ; nullptr = personnages complets.
+    void record(const PartInstance* parts, size_t n, CommandBuffer& cmds, size_t first,
+                uint16_t materialBase, const uint8_t* partIndex = nullptr) const;
+
+    // Passe linéaire sur le squelette + animation : remplit partCount() pièces.
+    // Sans GL ni état partagé : appelable depuis plusieurs threads à la fois.
+    void pose(float t, const AnimBlend& anim, bool paused, const Affine3x4& root, PartInstance* out) const;
+
+    // Niveaux de détail (cf. CrowdLod). Squelette fusionné : mergedPartCount()
+    // pièces, mergedPartIndex()[j] = pièce du squelette complet de même
+    // matériau (cf. record). Courbes analytiques même avec setBaked.
+    void poseMerged(float t, const AnimBlend& anim, bool paused, const Affine3x4& root, PartInstance* out) const;
+    int mergedPartCount() const { return M_.partCount(); }
+    const uint8_t* mergedPartIndex() const { return mergedIndex_; }
+    // Une seule boîte : AABB de la pose de repos, couleur du torse (pièce 0), sans animation
+    PartInstance poseBox(const Affine3x4& root) const;
+
+    // n personnages d'un coup (instants t[i], racines roots[i]) : courbes via
+    // evalBlendBatch ; out reçoit n × partCount() pièces, personnages à la suite.
+    // colors : autre palette que celle du rig (foules variées, cf. CrowdData).
+    void poseBatch(const float* t, int n, const AnimBlend& anim, bool paused, const Affine3x4* roots,
+                   PartInstance* out, const RigColors* colors = nullptr) const;
+
+    // Sphère englobante valable pour toute animation, dérivée de RigParams via
+    // le squelette : rayon autour de l'articulation racine, centre lu sur les
+    // pièces posées d'un personnage. Avant la pose, centrer sur la racine
+    // (crowdRoot) et ajouter kMaxAnimTranslation (rebond du torse).
+    float boundRadius() const { return bound_; }
+    glm::vec3 boundCenter(const PartInstance* parts) const { return transformPoint(parts[0].model, rootInPart0_); }
+
+    const Skeleton& skeleton() const { return S_; }
+    const RigParams& params() const { return P_; }
+    int partCount() const { return S_.partCount(); }
+
+    // Empreinte mémoire : l'objet et les tableaux des deux squelettes
+    size_t memoryBytes() const { return sizeof(*this) + S_.heapBytes() + M_.heapBytes(); }
 
 private:
-    // Helpers "placement only" (pas de couleur, pas de draw)
-    void placeTorso(MatrixStack& ms) const;
-    void placeHeadFromTorso(MatrixStack& ms) const;
-    void placeUpperArm(MatrixStack& ms) const;
-    void placeForearm(MatrixStack& ms, float elbowRot) const;
-    void placeThigh(MatrixStack& ms) const;
-    void placeShin(MatrixStack& ms, float kneeRot) const;
-
-    // Rendu bête : set model + set color + draw cube (UN seul draw par pièce)
-    inline void renderPart(MatrixStack& ms, const glm::vec4& color) const;
-
-    // Ressources / uniforms
-    GLint  uModel_;
-    GLint  uColor_;
-    GLuint cubeVAO_;
+    void rebuild();
+
+    // ch == nullptr : clip cuit échantillonné à tt
+    void poseAt(const AnimChannels* ch, const AnimBlend& anim, float tt, const Affine3x4& root,
+                const RigColors& colors, PartInstance* out) const;
 
     // État courant
     RigParams P_{};
     RigColors C_{};
+    Skeleton  S_{};
+    Skeleton  M_{}; // squelette fusionné (LOD)
+    uint8_t mergedIndex_[kMaxParts] = {};
+    glm::vec3 boxCenter_{0.0f}, boxSize_{1.0f}; // pose de repos, repère de la racine
+    const AnimLibrary* baked_ = nullptr;
+    uint32_t revision_ = 0;
+    float bound_ = 0.0f;
+    glm::vec3 rootInPart0_{0.0f}; // origine de l'articulation racine dans le cube de la pièce 0
 };
 
 #endif // CHARACTER_HPP
@@ -0,0 +1,92 @@
+// command_buffer.hpp
+#ifndef COMMAND_BUFFER_HPP
+#define COMMAND_BUFFER_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "affine.hpp"
+#include "cube.hpp"
+
+// Identifiants compacts des ressources référencées par les commandes
+// (indices dans les tables passées à l'exécution)
+enum MeshId : uint8_t { MeshCube = 0 };
+enum ProgramId : uint8_t { ProgramParts = 0 };
+
+// Clé de tri 64 bits, de l'état le plus cher au moins cher :
+//   programme (8) | maillage (8) | matériau (16) | profondeur / libre (32)
+inline uint64_t makeSortKey(uint8_t program, uint8_t mesh, uint16_t material, uint32_t depth = 0)
+{
+    return (uint64_t)program << 56 | (uint64_t)mesh << 48 | (uint64_t)material << 32 | depth;
+}
+
+// Un draw du chemin "une pièce = un draw" (16 octets)
+struct DrawCommand {
+    uint64_t key;
+    uint32_t transform; // indice dans CommandBuffer::transforms()
+    uint16_t material;  // indice dans CommandBuffer::materials()
+    uint8_t program;    // ProgramId
+    uint8_t mesh;       // MeshId
+};
+
+// Changements d'état qu'implique l'ordre d'exécution (la première commande
+// compte comme un changement de chaque type)
+struct CommandStats {
+    unsigned long commands = 0;
+    unsigned long programChanges = 0, meshChanges = 0, materialChanges = 0;
+    unsigned long changes() const { return programChanges + meshChanges + materialChanges; }
+    CommandStats& operator+=(const CommandStats& o);
+};
+
+// Liste de draws d'une frame : enregistrée (éventuellement depuis plusieurs
+// threads, chacun dans sa plage réservée par allocate()), triée par clé
+// (radix LSD, stable), puis exécutée par un backend (executeGL, ou compteurs
+// seuls). Les commandes restent en place ; le tri produit order().
+class CommandBuffer {
+public:
+    // Nouvelle frame (garde la capacité)
+    void clear();
+
+    // Séquentiel, avant l'enregistrement parallèle
+    uint16_t addMaterial(const glm::vec4& color);
+    // Réserve n commandes + transformations ; renvoie l'indice de la première
+    size_t allocate(size_t n);
+
+    // Écriture dans une plage réservée : plages disjointes → sans verrou
+    DrawCommand* commands() { return cmds_.data(); }
+    Affine3x4* transforms() { return transforms_.data(); }
+
+    // Tri par clé + compteurs avant / après
+    void sort();
+
+    size_t size() const { return cmds_.size(); }
+    const DrawCommand& command(size_t i) const { return cmds_[i]; }
+    const Affine3x4& transform(uint32_t i) const { return transforms_[i]; }
+    const glm::vec4& material(uint16_t i) const { return materials_[i]; }
+    const std::vector<uint32_t>& order() const { return order_; }
+
+    // Ordre d'enregistrement / ordre trié (valides après sort())
+    const CommandStats& unsortedStats() const { return unsorted_; }
+    const CommandStats& sortedStats() const { return sorted_; }
+
+private:
+    std::vector<DrawCommand> cmds_;
+    std::vector<Affine3x4> transforms_;
+    std::vector<glm::vec4> materials_;
+    std::vector<uint32_t> order_, scratch_;
+    CommandStats unsorted_, sorted_;
+};
+
+// Programme GL d'un ProgramId : identifiant + uniforms model / uColor
+struct ProgramSlot {
+    GLuint program;
+    GLint uModel, uColor;
+};
+
+// Backend GL immédiat : parcourt order() et ne change programme, maillage et
+// couleur qu'aux transitions (tables indexées par ProgramId / MeshId)
+void executeGL(const CommandBuffer& cmds, const ProgramSlot* programs, const UnitCube* meshes);
+
+#endif // COMMAND_BUFFER_HPP
@@ -0,0 +1,176 @@
+// crowd.hpp
+#ifndef CROWD_HPP
+#define CROWD_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "character.hpp"
+#include "cube.hpp"
+#include "frustum.hpp"
+
+class CommandBuffer;
+class CrowdData;
+class CrowdLod;
+class JobSystem;
+
+// Placement en grille du i-ème personnage d'une foule de `count`
+Affine3x4 crowdRoot(int i, int count);
+
+// Demi-largeur de la grille (pour reculer la caméra)
+float crowdExtent(int count);
+
+// Personnages par job des poses de foule (buildCrowdInstances, CrowdData,
+// CrowdLod, CrowdCuller) : 64 personnages (640 pièces), assez pour amortir
+// le vol ; multiple de kAnimBatch pour ne pas couper les blocs de poseBatch
+constexpr int kCrowdGrain = 64;
+static_assert(kCrowdGrain % kAnimBatch == 0, "kCrowdGrain must be a multiple of kAnimBatch");
+
+// Pose de toute la foule dans out (count * rig.partCount() instances).
+// Avec un JobSystem, les personnages sont répartis par tranches sur les workers.
+void buildCrowdInstances(const CharacterRenderer& rig, int count, float t, const AnimBlend& anim, bool paused,
+                         PartInstance* out, JobSystem* jobs = nullptr);
+
+// Même pose, mais enregistrée directement dans cmds (une commande par pièce,
+// cf. CharacterRenderer::record) pour le chemin "une pièce = un draw"
+void recordCrowd(const CharacterRenderer& rig, int count, float t, const AnimBlend& anim, bool paused,
+                 CommandBuffer& cmds, JobSystem* jobs = nullptr);
+
+// Tout ce dont dépendent les poses d'une foule. En pause le temps
+// n'intervient plus (toutes les poses sont celles de t = 0) : t vaut 0.
+struct PoseKey {
+    uint32_t rig = 0; // CharacterRenderer::revision() (CrowdData::revision() si varied)
+    int count = -1;   // -1 : aucune pose
+    AnimBlend anim;   // mélanges dans la CrowdData si varied
+    float t = 0.0f;
+    bool varied = false; // poses d'une CrowdData
+};
+inline bool operator==(const PoseKey& a, const PoseKey& b) {
+    return a.rig == b.rig && a.count == b.count && a.anim == b.anim && a.t == b.t && a.varied == b.varied;
+}
+inline bool operator!=(const PoseKey& a, const PoseKey& b) { return !(a == b); }
+
+PoseKey crowdPoseKey(const CharacterRenderer& rig, int count, float t, const AnimBlend& anim, bool paused);
+PoseKey crowdPoseKey(const CrowdData& crowd, float t, bool paused);
+
+// Poses de toute la foule (buildCrowdInstances) gardées avec leur clé :
+// reposées seulement quand le temps, le mélange, la taille de la foule ou le
+// rig (RigParams, RigColors, clips cuits) changent. En pause, rien n'est
+// recalculé d'une frame à l'autre.
+class CrowdPoseCache {
+public:
+    // true si les poses ont été recalculées
+    bool update(const CharacterRenderer& rig, int count, float t, const AnimBlend& anim, bool paused,
+                JobSystem* jobs = nullptr);
+    // Foule variée : CrowdData::pose (ordre du tri), reposée quand sa révision change
+    bool update(CrowdData& crowd, float t, bool paused, JobSystem* jobs = nullptr);
+
+    const PoseKey& key() const { return key_; }
+    const std::vector<PartInstance>& parts() const { return parts_; }
+
+private:
+    PoseKey key_;
+    std::vector<PartInstance> parts_;
+};
+
+// Culling de la foule contre le frustum de la caméra (cf. frustum.hpp) :
+//  1. sphères englobantes (CharacterRenderer::boundRadius) centrées sur les
+//     racines, testées 4 par 4 : les personnages hors champ ne sont pas posés ;
+//  2. sphères recentrées sur les poses : dedans → toutes les pièces,
+//     coupées par un plan (personnages proches, bords de l'écran) → chaque
+//     pièce testée comme une boîte orientée.
+// Résultat : pièces visibles compactées + indice de chaque pièce dans le
+// squelette (matériau, cf. CharacterRenderer::record).
+// Avec un CrowdLod, les personnages retenus sont posés par lui (niveaux de
+// détail, cadences réduites) et testés sur leur sphère de racine seulement.
+class CrowdCuller {
+public:
+    // Pose seulement les personnages visibles ; renvoie le nombre de pièces.
+    // f = nullptr : pas de culling (utile avec lod seul).
+    size_t build(const CharacterRenderer& rig, int count, float t, const AnimBlend& anim, bool paused,
+                 const Frustum* f, JobSystem* jobs = nullptr, CrowdLod* lod = nullptr);
+
+    // Étape 2 seule, sur des personnages déjà posés (n = count × partCount(),
+    // ex. poses interpolées de la boucle à pas fixe)
+    size_t filter(const CharacterRenderer& rig, const PartInstance* parts, size_t n, const Frustum& f);
+    // Foule variée (poses de CrowdData::pose) : sphères du plus grand rig
+    size_t filter(const CrowdData& crowd, const PartInstance* parts, size_t n, const Frustum& f);
+
+    // Pièces retenues : l'entrée elle-même si rien n'a été retiré (valide
+    // jusqu'au prochain appel, et tant que les pièces passées à filter le sont)
+    const PartInstance* parts() const { return parts_; }
+    const uint8_t* partIndex() const { return partIndex_.data(); }
+    // Personnage de chaque pièce retenue (indice dans les pièces passées à
+    // filter : palette, cf. CrowdData::record) ; filter seulement
+    const uint32_t* character() const { return character_.data(); }
+    const CullStats& stats() const { return stats_; } // dernière frame
+    double animMs() const { return animMs_; }          // poses de la dernière frame (build)
+
+private:
+    size_t collect(const CharacterRenderer& rig, int count, const Frustum* f, const CrowdLod& lod);
+    size_t filterSpheres(const CharacterRenderer& rig, float radius, const PartInstance* parts, size_t n,
+                         const Frustum& f);
+
+    std::vector<float> x_, y_, z_; // centres des sphères (SoA)
+    std::vector<uint8_t> class_;   // CullResult par personnage
+    std::vector<int> chars_;       // personnages retenus à l'étape 1
+    std::vector<PartInstance> posed_, visible_;
+    std::vector<uint8_t> partIndex_;
+    std::vector<uint32_t> character_;
+    const PartInstance* parts_ = nullptr;
+    CullStats stats_;
+    double animMs_ = 0.0;
+};
+
+// Rendu "foule" : toutes les pièces de tous les personnages dans un buffer
+// d'instances, puis UN seul draw instancié du cube unité (buffered ou procedural).
+// Attributs d'instance : 1..3 = lignes de la transformation (Affine3x4), 4 = couleur.
+// Variante texture buffer (setTextureBuffer) : mêmes 64 octets par pièce dans
+// un GL_TEXTURE_BUFFER RGBA32F, lus par le vertex shader avec texelFetch à
+// partir de gl_InstanceID ; aucun attribut d'instance à décrire.
+class CrowdRenderer {
+public:
+    explicit CrowdRenderer(const UnitCube& cube);
+    ~CrowdRenderer();
+
+    CrowdRenderer(const CrowdRenderer&) = delete;
+    CrowdRenderer& operator=(const CrowdRenderer&) = delete;
+
+    // Optionnel : évaluation des poses en parallèle (le thread GL ne fait
+    // plus que l'upload et le draw)
+    void setJobs(JobSystem* jobs) { jobs_ = jobs; }
+    JobSystem* jobs() const { return jobs_; }
+
+    // Pièces dans le texture buffer au lieu des attributs d'instance : le
+    // programme actif doit alors être SceneGL::tboProg
+    void setTextureBuffer(bool on);
+    bool textureBuffer() const { return textureBuffer_; }
+
+    // Temps CPU des uploads du dernier draw (glBufferData / glBufferSubData)
+    double uploadMs() const { return uploadMs_; }
+
+    // Le programme instancié doit être actif. Poses inchangées depuis le
+    // draw précédent (pause) : ni pose ni upload, le VBO est redessiné tel quel.
+    void draw(const CharacterRenderer& rig, int count, float t, const AnimBlend& anim, bool paused);
+
+    // Pièces déjà posées (ex. interpolées par la boucle à pas fixe) : upload + draw
+    void draw(const PartInstance* parts, size_t n);
+
+private:
+    // Pièces [0, n) déjà dans le buffer courant → draw(s)
+    void drawUploaded(size_t n);
+
+    UnitCube cube_;
+    GLuint instanceVBO_ = 0;
+    size_t capacity_ = 0; // en instances (taille allouée du VBO)
+    GLuint instanceTBO_ = 0, instanceTexture_ = 0;
+    size_t tboCapacity_ = 0;
+    size_t tboMaxInstances_ = 0; // GL_MAX_TEXTURE_BUFFER_SIZE / 4 : au-delà, un draw par tranche
+    bool textureBuffer_ = false;
+    double uploadMs_ = 0.0;
+    CrowdPoseCache poses_;
+    bool posesUploaded_ = false; // le VBO contient poses_
+    JobSystem* jobs_ = nullptr;
+};
+
+#endif // CROWD_HPP
@@ -0,0 +1,130 @@
+// crowd_data.hpp
+#ifndef CROWD_DATA_HPP
+#define CROWD_DATA_HPP
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "character.hpp"
+
+class CommandBuffer;
+class JobSystem;
+
+// Un personnage d'une foule variée (cf. CrowdData::add)
+struct CrowdMember {
+    glm::vec2 position{0.0f}; // racine (x, z) au sol
+    float phase = 0.0f;       // décalage temporel (s)
+    float speed = 1.0f;       // temps d'animation = t × speed + phase
+    uint8_t blend = 0;   // table des mélanges (addBlend)
+    uint8_t rig = 0;     // table des tailles (addRig)
+    uint8_t palette = 0; // table des palettes (addPalette)
+};
+
+// Foule hétérogène : position, phase, vitesse, mélange, tailles et palette de
+// chaque personnage en SoA. Mélanges (AnimBlend : modes, fondus, couches),
+// tailles et palettes sont des tables partagées et dédupliquées, référencées
+// par des indices 8 bits.
+// Les personnages restent triés par (rig, mélange, palette) : une pose de la
+// foule parcourt les tableaux linéairement, plage homogène par plage
+// homogène, en blocs de kAnimBatch pour poseBatch (poids du mélange communs
+// au bloc). add / assignBlend ne font que marquer le tri à refaire (tri par
+// comptage, au prochain pose).
+class CrowdData {
+public:
+    // Indice dans la table (celui de l'entrée égale s'il y en a une) ; 256 au plus
+    int addBlend(const AnimBlend& b);
+    int addRig(const RigParams& p);
+    int addPalette(const RigColors& c);
+    int blendCount() const { return (int)blends_.size(); }
+    int rigCount() const { return (int)rigs_.size(); }
+    int paletteCount() const { return (int)palettes_.size(); }
+    const AnimBlend& blend(int i) const { return blends_[i]; }
+    const CharacterRenderer& rig(int i) const { return rigs_[i]; }
+    const RigColors& palette(int i) const { return palettes_[i]; }
+    // Change l'entrée i pour tous ses personnages (ex. fondu walk → jump de
+    // toute une plage) : ni tri ni copie par personnage
+    void setBlend(int i, const AnimBlend& b);
+
+    // Identifiant stable (indépendant du tri) ; blend, rig et palette doivent exister
+    int add(const CrowdMember& m);
+    // Personnage id tel qu'ajouté, mélange courant (assignBlend) compris
+    CrowdMember member(int id) const;
+    void assignBlend(int id, int blend);
+    void setMode(int id, AnimMode mode) { assignBlend(id, addBlend(mode)); }
+    void clear(); // tables comprises
+
+    int size() const { return (int)id_.size(); }
+    // Pièces par personnage : les mêmes pour toutes les tailles (buildHumanoid)
+    int partCount() const { return rigs_.empty() ? 0 : rigs_[0].partCount(); }
+    // Plus grand CharacterRenderer::boundRadius des tailles (culling) ; le
+    // torse est centré sur la racine pour toutes, boundCenter de rig(0) vaut
+    // pour tous les personnages
+    float boundRadius() const;
+
+    // Incrémentée à chaque changement effectif (personnages, tables, tri
+    // exclu) : deux poses de même révision et même temps sont identiques
+    // (cf. CrowdPoseCache)
+    uint32_t revision() const { return revision_; }
+
+    // Poses de toute la foule à l'instant t : size() × partCount() pièces,
+    // dans l'ordre du tri (personnage id à la place slot(id))
+    void pose(float t, bool paused, PartInstance* out, JobSystem* jobs = nullptr);
+    int slot(int id) const { return (int)slot_[id]; }
+
+    // Trie si nécessaire (appelé par pose)
+    void sort();
+    int runCount() const { return (int)runs_.size(); }
+
+    // Chemin une pièce = un draw : SlotCount matériaux par palette (une fois
+    // par frame, avant record) ; renvoie le premier
+    uint16_t recordMaterials(CommandBuffer& cmds) const;
+    // Comme CharacterRenderer::record, pour des pièces de pose() (foule
+    // triée), matériau pris dans la palette de chaque personnage.
+    // character : personnage (place) de chaque pièce quand parts a été
+    // filtré (cf. CrowdCuller::character), avec partIndex ; nullptr = foule complète.
+    void record(const PartInstance* parts, size_t n, CommandBuffer& cmds, size_t first, uint16_t materialBase,
+                const uint8_t* partIndex = nullptr, const uint32_t* character = nullptr) const;
+
+    // Mémoire : tableaux par personnage, et tables partagées (mélanges,
+    // palettes, et CharacterRenderer complets avec leurs squelettes)
+    static constexpr size_t kBytesPerCharacter = 4 * sizeof(float) + 3 * sizeof(uint8_t) + 2 * sizeof(uint32_t);
+    size_t tableBytes() const;
+
+private:
+    // Plage [begin, end) de personnages de même rig, mélange et palette
+    struct Run {
+        int begin, end;
+        uint8_t rig, blend, palette;
+    };
+
+    std::vector<float> x_, z_, phase_, speed_;
+    std::vector<uint8_t> blend_, rig_, palette_;
+    std::vector<uint32_t> id_;   // place → identifiant
+    std::vector<uint32_t> slot_; // identifiant → place
+    std::vector<Run> runs_;
+    bool sorted_ = true;
+    uint32_t revision_ = 0;
+
+    std::vector<AnimBlend> blends_;
+    std::vector<CharacterRenderer> rigs_;
+    std::vector<RigColors> palettes_;
+};
+
+// Variété générée par populateCrowd
+struct CrowdVariety {
+    int rigs = 4;            // variantes de tailles (RigParams par défaut ± 20 %)
+    int palettes = 8;        // variantes de palette
+    bool mixedModes = true;  // idle / walk / jump et fondus walk → idle (sinon tous en walk)
+    float speedJitter = 0.2f; // vitesse dans [1 - j, 1 + j]
+    float phaseSpan = 3.0f;   // décalages dans [0, span) s (≈ un cycle de marche ou plus)
+    uint32_t seed = 1;
+};
+
+// count personnages sur la grille de crowdRoot, phases en suite de Weyl du
+// nombre d'or (0 pour le premier, bien réparties quel que soit count), le
+// reste tiré d'un générateur déterministe. CrowdVariety{1, 1, false, 0, 0} :
+// mêmes poses que buildCrowdInstances en walk.
+void populateCrowd(CrowdData& crowd, int count, const CrowdVariety& v = CrowdVariety());
+
+#endif // CROWD_DATA_HPP
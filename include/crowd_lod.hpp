@@ -0,0 +1,83 @@
+// crowd_lod.hpp
+#ifndef CROWD_LOD_HPP
+#define CROWD_LOD_HPP
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "character.hpp"
+
+class JobSystem;
+
+// Niveaux de détail de l'animation, du plus proche au plus lointain
+enum LodTier : uint8_t {
+    LodFull,     // squelette complet, posé à chaque frame
+    LodHalfRate, // squelette complet, une frame sur 2
+    LodMerged,   // squelette fusionné (6 pièces), une frame sur 4
+    LodBox,      // une boîte, posée seulement en entrant dans le niveau
+    LodTierCount
+};
+
+struct LodSettings {
+    // Distance caméra → racine au-delà de laquelle on passe au niveau suivant.
+    // À 800×600 et 60° de champ, un personnage y mesure ~50, 25 et 12 pixels.
+    float distance[LodTierCount - 1] = {25.0f, 50.0f, 100.0f};
+    // Hystérésis : on descend au-delà de distance × (1 + h), on remonte en
+    // deçà de distance × (1 - h) ; pas d'aller-retour autour d'un seuil
+    float hysteresis = 0.1f;
+};
+
+// Compteurs de la dernière frame
+struct LodStats {
+    size_t characters[LodTierCount] = {};
+    size_t posed = 0; // personnages réellement posés
+    size_t parts = 0; // pièces produites
+};
+
+// État persistant d'une foule : niveau et dernière pose de chaque personnage.
+// Les mises à jour à cadence réduite sont étalées (personnage i posé quand
+// (frame + i) % cadence == 0) : le coût par frame reste régulier.
+// Seul renderScene s'en sert (bench à un thread). La boucle à pas fixe
+// (fenêtre, --render-thread : renderParts) interpole deux poses complètes
+// pièce à pièce ; un personnage qui change de niveau entre les deux pas
+// n'aurait ni le même nombre ni les mêmes pièces, la LOD y est ignorée.
+class CrowdLod {
+public:
+    LodSettings settings;
+
+    // Caméra de la frame (distances)
+    void setEye(const glm::vec3& eye) { eye_ = eye; }
+
+    // Une frame : niveaux des personnages `chars` (indices dans la foule de
+    // `count`, crowdRoot) recalculés, puis pose de ceux qui sont
+    // dus. Un personnage absent à la frame précédente (hors champ) est reposé.
+    void update(const CharacterRenderer& rig, int count, const std::vector<int>& chars, float t, const AnimBlend& anim,
+                bool paused, JobSystem* jobs = nullptr);
+
+    // Dernière pose du personnage i : partCount(i) pièces, indices dans le
+    // squelette complet (matériaux, cf. CharacterRenderer::record)
+    const PartInstance* parts(int i) const { return &cache_[(size_t)i * stride_]; }
+    int partCount(int i) const { return live_[i]; }
+    const uint8_t* partIndex(int i) const { return tierIndex_[tier_[i]]; }
+    LodTier tier(int i) const { return (LodTier)tier_[i]; }
+
+    const LodStats& stats() const { return stats_; }
+
+    // Oublie les poses (aussi fait par update quand rig.revision() change)
+    void reset() { count_ = -1; }
+
+private:
+    glm::vec3 eye_{0.0f};
+    int count_ = -1, stride_ = 0;
+    uint32_t revision_ = 0; // CharacterRenderer::revision() des poses en cache
+    uint32_t frame_ = 0;
+    std::vector<PartInstance> cache_; // count × stride_ pièces
+    std::vector<uint8_t> tier_, live_;
+    std::vector<uint32_t> seen_;          // dernière frame où le personnage a été traité
+    std::vector<int> due_[LodTierCount];  // personnages à poser cette frame
+    uint8_t tierIndex_[LodTierCount][kMaxParts] = {};
+    LodStats stats_;
+};
+
+#endif // CROWD_LOD_HPP
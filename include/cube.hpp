@@ -6,4 +6,17 @@
 GLuint make_unit_cube();
 void draw_unit_cube(GLuint vao);
 
+// Variante sans buffers : VAO vide, le vertex shader (PROCEDURAL_CUBE)
+// génère les 36 coins depuis gl_VertexID → glDrawArrays, ni vertex ni index fetch
+GLuint make_procedural_cube();
+
+// Cube choisi au démarrage (A/B buffered vs procedural)
+struct UnitCube {
+    GLuint vao = 0;
+    bool procedural = false;
+};
+
+void draw_cube(const UnitCube &cube);
+void draw_cube_instanced(const UnitCube &cube, GLsizei instances);
+
 #endif
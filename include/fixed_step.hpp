@@ -0,0 +1,40 @@
+// fixed_step.hpp
+#ifndef FIXED_STEP_HPP
+#define FIXED_STEP_HPP
+
+#include <cstddef>
+#include "character.hpp"
+
+// Horloge de simulation à pas fixe : les poses avancent par pas de dt quelle
+// que soit la cadence d'affichage, le rendu interpole entre les deux derniers
+// instantanés (un pas de latence).
+class FixedStep {
+public:
+    explicit FixedStep(double dt = 1.0 / 60.0, int maxSteps = 8) : dt_(dt), maxSteps_(maxSteps) {}
+
+    // Ajoute le temps réel écoulé ; renvoie le nombre de pas dus. Au-delà de
+    // maxSteps (frame très lente, fenêtre déplacée…), le retard est abandonné
+    // plutôt que rattrapé : pas de spirale.
+    int advance(double elapsed);
+
+    double dt() const { return dt_; }
+    // Temps du dernier pas simulé
+    double time() const { return time_; }
+    // Fraction du pas suivant déjà écoulée, dans [0, 1)
+    float alpha() const { return (float)(acc_ / dt_); }
+    // Temps affiché : entre time() - dt et time()
+    double renderTime() const { return time_ - dt_ + acc_; }
+
+private:
+    double dt_;
+    int maxSteps_;
+    double time_ = 0.0;
+    double acc_ = 0.0;
+};
+
+// out[i] = mix(a[i], b[i], alpha), transformations composante par composante.
+// Sur un pas de 1/60 s les rotations sont petites : l'écart à une vraie
+// interpolation (slerp) est invisible et ne coûte aucune réévaluation de pose.
+void lerpPoses(const PartInstance* a, const PartInstance* b, size_t n, float alpha, PartInstance* out);
+
+#endif // FIXED_STEP_HPP
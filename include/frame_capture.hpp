@@ -0,0 +1,111 @@
+// frame_capture.hpp
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sortie d'une capture : séquence d'images (pattern printf, ex.
+// "out/frame_%05d.png" ; format selon l'extension .ppm, .png, .raw / .rgba)
+// ou images RGBA brutes, ligne 0 = haut, envoyées sur l'entrée standard
+// d'une commande (ex. ffmpeg -f rawvideo -pix_fmt rgba -s 1920x1080 -i - out.mp4)
+struct CaptureOptions {
+    std::string pattern;
+    std::string pipe;
+    int depth = 3;  // PBO en vol : une frame est lue `depth` frames plus tard ; 0 = glReadPixels synchrone
+    int queue = 8;  // frames en attente du writer au plus
+    bool dropWhenFull = false; // writer en retard : frame perdue au lieu d'attendre
+    bool enabled() const { return !pattern.empty() || !pipe.empty(); }
+};
+
+struct CaptureStats {
+    int captured = 0;    // frames passées au writer
+    int written = 0;     // frames écrites
+    int dropped = 0;     // file pleine (dropWhenFull), taille différente ou PBO non mappable
+    int stalls = 0;      // PBO pas encore rempli au moment de le lire
+    double readMs = 0;   // thread de rendu : glReadPixels, map, copie (cumulé)
+    double waitMs = 0;   // thread de rendu : attente d'un tampon libre (cumulé)
+    double writeMs = 0;  // thread writer (cumulé)
+    double wallMs = 0;   // première capture → fin du writer (finish)
+    bool failed = false; // écriture impossible ou encodeur en échec (détail dans error())
+};
+
+// Capture asynchrone du framebuffer lu (FBO headless ou back buffer) :
+// capture() lance glReadPixels dans un anneau de GL_PIXEL_PACK_BUFFER et
+// reprend le PBO écrit `depth` frames plus tôt (map, copie dans un tampon du
+// pool, unmap) ; un thread writer encode et écrit les frames dans l'ordre.
+// Le thread de rendu n'attend ni le GPU (sauf PBO en retard : stalls) ni
+// le disque (sauf file pleine : waitMs).
+// Construction, capture() et finish() : thread qui possède le contexte GL.
+class FrameCapture {
+public:
+    FrameCapture(int width, int height, const CaptureOptions& opt);
+    ~FrameCapture(); // finish() si pas encore fait (contexte encore courant), SIGPIPE rendu
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // false si la sortie n'a pas pu être ouverte (cf. error())
+    bool ok() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+    // Après le rendu d'une frame de taille width × height (sinon perdue)
+    void capture(int width, int height);
+    // Frames encore en vol lues (en attendant le GPU), writer terminé, PBO libérés
+    void finish();
+
+    CaptureStats stats() const;
+
+private:
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        int index = -1; // frame lue dans ce PBO, -1 = libre
+    };
+    struct Frame {
+        std::vector<uint8_t> pixels; // RGBA, ligne 0 = bas
+        int index = 0;
+    };
+
+    bool acquire(std::vector<uint8_t>& out); // tampon libre du pool
+    void push(std::vector<uint8_t>&& pixels, int index);
+    void retire(Slot& s);
+    void closePipe();
+    void writerLoop();
+    bool write(const Frame& f);
+
+    int width_, height_;
+    CaptureOptions opt_;
+    std::string error_;
+    std::vector<Slot> slots_;
+    int next_ = 0;
+    int frame_ = 0;
+    bool finished_ = false;
+    double firstCapture_ = -1.0; // ms (steady_clock)
+
+    // Partagé avec le writer
+    mutable std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<Frame> queue_;
+    std::vector<std::vector<uint8_t>> free_;
+    bool quit_ = false;
+    CaptureStats stats_;
+    std::FILE* pipe_ = nullptr;
+    void (*sigpipe_)(int) = SIG_ERR; // gestionnaire de SIGPIPE avant la capture
+    std::thread writer_;
+};
+
+void printCaptureStats(std::ostream& os, const CaptureOptions& opt, const CaptureStats& s, int width, int height);
+
+#endif // FRAME_CAPTURE_HPP
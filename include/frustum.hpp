@@ -0,0 +1,41 @@
+// frustum.hpp
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include "affine.hpp"
+
+// Les 6 plans du volume de vue, normales vers l'intérieur et normalisées :
+// p visible par le plan i si nx[i] * p.x + ny[i] * p.y + nz[i] * p.z + d[i] >= 0.
+// SoA sur 8 (2 registres SSE) : les plans 6 et 7 sont neutres (0, 0, 0, 1).
+struct Frustum {
+    alignas(16) float nx[8], ny[8], nz[8], d[8];
+};
+
+// Plans extraits de viewProj (Gribb-Hartmann, clip OpenGL -w ≤ z ≤ w)
+Frustum extractFrustum(const glm::mat4& viewProj);
+
+enum CullResult : uint8_t { CullOutside, CullIntersect, CullInside };
+
+// n sphères de même rayon, centres en SoA → out[i]. 4 sphères par itération
+// en SSE / NEON (tous les plans testés sans branche), reste en scalaire.
+// -DFRUSTUM_SCALAR force le chemin scalaire.
+void classifySpheres(const Frustum& f, const float* x, const float* y, const float* z, float radius, size_t n,
+                     uint8_t* out);
+
+// Cube unité centré transformé par model (une pièce) : boîte orientée, rayon
+// projeté sur chaque normale. false si elle est entièrement derrière un plan.
+bool boxVisible(const Frustum& f, const Affine3x4& model);
+
+// Compteurs d'une frame (ou cumulés, cf. operator+=)
+struct CullStats {
+    size_t characters = 0, charactersCulled = 0;
+    size_t parts = 0, partsCulled = 0; // toutes les pièces, dont celles des personnages rejetés
+    size_t partsTested = 0;            // testées une à une (personnages coupés par un plan)
+
+    CullStats& operator+=(const CullStats& o);
+};
+
+#endif // FRUSTUM_HPP
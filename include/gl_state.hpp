@@ -0,0 +1,103 @@
+// gl_state.hpp
+#ifndef GL_STATE_HPP
+#define GL_STATE_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstring>
+#include "affine.hpp"
+#include "gl_stats.hpp"
+
+// Couche fine de suivi d'état GL (un seul contexte) : garde en cache le VAO
+// et le programme liés ainsi que les dernières valeurs d'uniforms, et saute
+// les appels redondants (comptés dans g_glStats.skipped).
+// Tout bind de VAO / programme doit passer par ici pour que le cache reste juste.
+namespace glstate {
+
+constexpr int kMaxCachedLocations = 32;
+constexpr GLuint kUnknown = 0xFFFFFFFFu; // état réel inconnu : le prochain bind passe
+
+struct UniformSlot {
+    GLuint program = kUnknown; // slot vide
+    float value[16];
+};
+
+struct State {
+    GLuint vao = kUnknown;
+    GLuint program = kUnknown;
+    UniformSlot uniforms[kMaxCachedLocations];
+};
+
+extern State g_state;
+
+// Oublie tout (ex. après du code GL externe ou un changement de contexte)
+void invalidate();
+
+inline void bindVertexArray(GLuint vao)
+{
+    if (g_state.vao == vao)
+    {
+        ++g_glStats.skipped[CallBindVertexArray];
+        return;
+    }
+    g_state.vao = vao;
+    glBindVertexArray(vao);
+}
+
+inline void useProgram(GLuint prog)
+{
+    if (g_state.program == prog)
+    {
+        ++g_glStats.skipped[CallUseProgram];
+        return;
+    }
+    g_state.program = prog;
+    glUseProgram(prog);
+}
+
+// true si (programme courant, loc) contient déjà ces n floats ; sinon les retient
+inline bool uniformCached(GLint loc, const float* v, size_t n)
+{
+    if (loc < 0 || loc >= kMaxCachedLocations)
+        return false;
+    UniformSlot& s = g_state.uniforms[loc];
+    if (s.program == g_state.program && std::memcmp(s.value, v, n * sizeof(float)) == 0)
+        return true;
+    s.program = g_state.program;
+    std::memcpy(s.value, v, n * sizeof(float));
+    return false;
+}
+
+inline void uniform4fv(GLint loc, const glm::vec4& v)
+{
+    if (uniformCached(loc, &v[0], 4))
+    {
+        ++g_glStats.skipped[CallUniform4fv];
+        return;
+    }
+    glUniform4fv(loc, 1, &v[0]);
+}
+
+inline void uniformMatrix4fv(GLint loc, const glm::mat4& m)
+{
+    if (uniformCached(loc, &m[0][0], 16))
+    {
+        ++g_glStats.skipped[CallUniformMatrix4fv];
+        return;
+    }
+    glUniformMatrix4fv(loc, 1, GL_FALSE, &m[0][0]);
+}
+
+inline void uniformMatrix3x4fv(GLint loc, const Affine3x4& m)
+{
+    if (uniformCached(loc, &m[0][0], 12))
+    {
+        ++g_glStats.skipped[CallUniformMatrix3x4fv];
+        return;
+    }
+    glUniformMatrix3x4fv(loc, 1, GL_FALSE, &m[0][0]);
+}
+
+} // namespace glstate
+
+#endif // GL_STATE_HPP
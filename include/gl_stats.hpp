@@ -0,0 +1,40 @@
+// gl_stats.hpp
+#ifndef GL_STATS_HPP
+#define GL_STATS_HPP
+
+#include <glad/glad.h>
+
+// Compteurs d'appels GL par type (mode --bench) : appels réellement envoyés
+// au driver, et appels redondants évités par glstate (cf. gl_state.hpp).
+enum GLCall {
+    CallDrawElements,
+    CallDrawElementsInstanced,
+    CallDrawArrays,
+    CallDrawArraysInstanced,
+    CallUniformMatrix4fv,
+    CallUniformMatrix3x4fv,
+    CallUniform4fv,
+    CallBindVertexArray,
+    CallUseProgram,
+    CallBufferData,
+    CallBufferSubData,
+    CallCount
+};
+
+struct GLCallStats {
+    unsigned long calls[CallCount] = {};
+    unsigned long skipped[CallCount] = {};
+    void reset() { *this = GLCallStats{}; }
+    unsigned long total() const;
+    unsigned long totalSkipped() const;
+};
+
+extern GLCallStats g_glStats;
+
+const char* glCallName(int call);
+
+// À appeler après gladLoadGL : remplace les pointeurs glad des appels suivis
+// par des wrappers qui comptent puis délèguent au driver.
+void installGLCallCounters();
+
+#endif // GL_STATS_HPP
@@ -3,9 +3,69 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include "affine.hpp"
+#include "gl_state.hpp"
 
-inline void setModel(GLint uModel, const glm::mat4 &M)
+// uniform mat3x4 model : les 3 lignes de l'Affine3x4 sont ses colonnes
+inline void setModel(GLint uModel, const Affine3x4 &M)
 {
-    glUniformMatrix4fv(uModel, 1, GL_FALSE, &M[0][0]);
+    glstate::uniformMatrix3x4fv(uModel, M);
 }
-#endif
\ No newline at end of file
+
+// ---------------------- Données par frame (UBO std140 partagé) ----------------------
+
+// Point de binding du bloc "FrameData" commun à tous les programmes
+constexpr GLuint kFrameBinding = 0;
+
+// Miroir CPU du bloc std140 FrameData (mat4 = 4 vec4, vec4 aligné sur 16) :
+// une seule mise à jour par frame, quel que soit le nombre de programmes.
+struct FrameUniforms
+{
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::mat4 viewProj{1.0f}; // prémultipliée : un produit de moins par sommet
+    glm::vec4 time{0.0f};     // x = secondes
+};
+static_assert(sizeof(FrameUniforms) == 208, "FrameUniforms must match the std140 FrameData layout");
+
+inline GLuint createFrameUBO()
+{
+    GLuint ubo;
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameBinding, ubo);
+    return ubo;
+}
+
+inline void updateFrameUBO(GLuint ubo, const FrameUniforms &f)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &f);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// GLSL 4.1 n'a pas layout(binding) sur les blocs : on relie après le link
+inline void bindFrameBlock(GLuint prog)
+{
+    GLuint idx = glGetUniformBlockIndex(prog, "FrameData");
+    if (idx != GL_INVALID_INDEX)
+        glUniformBlockBinding(prog, idx, kFrameBinding);
+}
+
+// ---------------------- Instances en texture buffer ----------------------
+
+// Unité de texture du samplerBuffer uInstances (simple.vert en TBO_INSTANCES)
+constexpr GLint kInstanceTextureUnit = 0;
+
+// Même chose pour le sampler : fixé une fois après le link
+inline void bindInstanceSampler(GLuint prog)
+{
+    const GLint loc = glGetUniformLocation(prog, "uInstances");
+    if (loc < 0)
+        return;
+    glstate::useProgram(prog);
+    glUniform1i(loc, kInstanceTextureUnit);
+}
+#endif
@@ -0,0 +1,21 @@
+// headless.hpp
+#ifndef HEADLESS_HPP
+#define HEADLESS_HPP
+
+#include <glad/glad.h>
+
+// Contexte GL 4.1 core sans fenêtre + FBO couleur/profondeur de la taille
+// demandée (il n'y a pas de framebuffer par défaut en surfaceless).
+// Linux (HUMANGL_EGL) : EGL surfaceless, ex. Mesa llvmpipe sans GPU.
+// Ailleurs : fenêtre GLFW invisible.
+struct HeadlessGL {
+    void* display = nullptr; // EGLDisplay ou GLFWwindow*
+    void* context = nullptr;
+    GLuint fbo = 0, color = 0, depth = 0;
+    int width = 0, height = 0;
+};
+
+bool createHeadlessGL(int width, int height, HeadlessGL& out);
+void destroyHeadlessGL(HeadlessGL& h);
+
+#endif // HEADLESS_HPP
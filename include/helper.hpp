@@ -1,8 +1,15 @@
 #ifndef HELPER_HPP
 #define HELPER_HPP
 
+#include <cstdint>
 #include <string>
 
 std::string loadFile(const char *path);
 
+// Image RGBA8 ligne 0 = bas (glReadPixels) → PPM binaire (P6), alpha ignoré
+bool writePPM(const char *path, int width, int height, const uint32_t *rgba);
+// Même entrée → PNG RGB 8 bits, deflate sans compression (blocs stockés) :
+// aucune dépendance, écriture rapide, fichiers de la taille du PPM
+bool writePNG(const char *path, int width, int height, const uint32_t *rgba);
+
 #endif
@@ -0,0 +1,57 @@
+// jobs.hpp
+#ifndef JOBS_HPP
+#define JOBS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Système de jobs minimal : une deque par worker, le propriétaire dépile par
+// l'arrière, les workers inactifs volent par l'avant. Le thread appelant de
+// parallelFor() compte comme worker 0 et participe au travail.
+class JobSystem {
+public:
+    // threads = 0 → un worker par cœur (hardware_concurrency)
+    explicit JobSystem(unsigned threads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned workerCount() const { return (unsigned)queues_.size(); }
+
+    // Découpe [0, count) en tranches de `grain` et appelle fn(begin, end) en
+    // parallèle. Bloque jusqu'à la fin de toutes les tranches.
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+
+private:
+    struct Job {
+        const std::function<void(int, int)>* fn;
+        int begin, end;
+    };
+    struct Queue {
+        std::mutex m;
+        std::deque<Job> jobs;
+    };
+
+    bool pop(unsigned self, Job& out);
+    bool steal(unsigned self, Job& out);
+    void run(const Job& j);
+    void workerLoop(unsigned self);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::atomic<int> queued_{0};  // jobs encore dans une deque
+    std::atomic<int> pending_{0}; // jobs pas encore terminés
+    std::mutex wakeM_;
+    std::condition_variable wakeCv_;
+    bool quit_ = false;
+};
+
+#endif // JOBS_HPP
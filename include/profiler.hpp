@@ -0,0 +1,110 @@
+// profiler.hpp
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Profileur de frame : zones CPU nommées (PROFILE_ZONE, durée de la portée)
+// et zones GPU (PROFILE_GPU_ZONE, requêtes GL_TIME_ELAPSED lues kGpuLatency
+// frames plus tard, sans attendre le GPU). Chaque thread écrit dans son
+// propre anneau, sans verrou ; endFrame() les vide depuis un seul thread.
+// Sortie : moyennes glissantes par zone (report) et trace Chrome
+// (chrome://tracing, Perfetto) des frames capturées.
+//
+// Compilé seulement avec -DHUMANGL_PROFILE (make PROFILE=1) : sinon les
+// macros disparaissent et les fonctions sont vides, coût nul.
+//
+// Noms de zone : chaînes littérales (gardées par pointeur). Les zones GPU ne
+// s'imbriquent pas (une requête GL_TIME_ELAPSED active à la fois) : une zone
+// GPU ouverte dans une autre n'est pas mesurée.
+
+namespace prof {
+
+constexpr int kGpuLatency = 3; // frames entre une requête GPU et sa lecture
+constexpr int kWindow = 120;   // frames des moyennes glissantes
+
+#ifdef HUMANGL_PROFILE
+
+constexpr bool kEnabled = true;
+
+// Horodatage en nanosecondes (horloge monotone)
+inline uint64_t now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Zone terminée sur le thread courant ; gpu : durée GPU, begin = soumission
+void record(const char* name, uint64_t begin, uint64_t end, bool gpu = false);
+// Nom du thread dans la trace (sinon "thread N")
+void setThreadName(const char* name);
+
+struct Zone {
+    const char* name;
+    uint64_t begin;
+    explicit Zone(const char* n) : name(n), begin(now()) {}
+    ~Zone() { record(name, begin, now()); }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+};
+
+// GPU : thread qui possède le contexte GL uniquement
+void gpuBegin(const char* name);
+void gpuEnd();
+// Une fois par frame après la soumission (swap / glFinish) : lit les
+// requêtes de la frame d'il y a kGpuLatency frames si elles sont prêtes
+void gpuFrame();
+// Avant la destruction du contexte : lit (en attendant) ce qui reste et
+// libère les requêtes ; recréées au prochain gpuBegin
+void gpuShutdown();
+
+struct GpuZone {
+    explicit GpuZone(const char* n) { gpuBegin(n); }
+    ~GpuZone() { gpuEnd(); }
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+};
+
+// Fin de frame : vide les anneaux de tous les threads dans les moyennes
+// glissantes (et la capture en cours). Un seul thread appelant.
+void endFrame();
+// ms / frame et appels / frame de chaque zone sur les kWindow dernières frames
+void report(std::ostream& os);
+
+// Capture des zones pour la trace Chrome, jusqu'à maxEvents
+void startCapture(size_t maxEvents = 1u << 20);
+bool writeChromeTrace(const char* path);
+
+#define PROFILE_CAT2(a, b) a##b
+#define PROFILE_CAT(a, b) PROFILE_CAT2(a, b)
+#define PROFILE_ZONE(name) prof::Zone PROFILE_CAT(profZone_, __LINE__)(name)
+#define PROFILE_GPU_ZONE(name) prof::GpuZone PROFILE_CAT(profGpuZone_, __LINE__)(name)
+
+#else
+
+constexpr bool kEnabled = false;
+
+inline void setThreadName(const char*) {}
+inline void gpuFrame() {}
+inline void gpuShutdown() {}
+inline void endFrame() {}
+inline void report(std::ostream&) {}
+inline void startCapture(size_t = 0) {}
+inline bool writeChromeTrace(const char*) { return false; }
+
+#define PROFILE_ZONE(name) \
+    do {                   \
+    } while (0)
+#define PROFILE_GPU_ZONE(name) \
+    do {                       \
+    } while (0)
+
+#endif
+
+} // namespace prof
+
+#endif // PROFILER_HPP
@@ -0,0 +1,68 @@
+// scene.hpp
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <glad/glad.h>
+#include "character.hpp"
+#include "command_buffer.hpp"
+#include "gpu.hpp"
+#include "crowd.hpp"
+#include "crowd_lod.hpp"
+
+class CrowdData;
+
+// Ressources GL communes à la boucle interactive et au mode --bench
+struct SceneGL {
+    GLuint prog = 0;     // simple.vert/frag : une pièce = un draw
+    GLuint instProg = 0; // instanced.vert/frag : foule en un draw
+    GLuint tboProg = 0;  // simple.vert en TBO_INSTANCES + instanced.frag : foule en un draw, pièces en texture buffer
+    GLint uModel = -1, uColor = -1;
+    UnitCube cube;
+    GLuint frameUBO = 0;  // bloc FrameData (caméra + temps), binding kFrameBinding
+    FrameUniforms frame;  // copie CPU, envoyée une fois par frame
+    CommandBuffer commands; // chemin une pièce = un draw : commandes de la dernière frame
+    bool culling = true;    // frustum culling de la foule (cf. CrowdCuller)
+    bool lod = false;       // niveaux de détail de l'animation (renderScene seulement, cf. CrowdLod)
+    CrowdCuller culler;     // pièces visibles + compteurs de la dernière frame
+    CrowdLod crowdLod;      // niveaux et poses en cache d'une frame à l'autre
+};
+
+// Répertoire par défaut du cache de binaires de programme (cf. buildProgram)
+constexpr const char* kShaderCacheDir = ".shader_cache";
+
+// Compile (ou recharge depuis shaderCache, nullptr = sans cache) les
+// programmes et crée le cube unité (contexte GL courant requis).
+// proceduralCube : cube généré depuis gl_VertexID (shaders en PROCEDURAL_CUBE)
+SceneGL loadSceneGL(const char* shaderCache = kShaderCacheDir, bool proceduralCube = false);
+
+// Fond commun aux backends GL et logiciel (soft_raster.hpp)
+const glm::vec4 kSceneClearColor(0.08f, 0.09f, 0.11f, 1.f);
+
+// Matrices cam/proj : la caméra recule avec la taille de la foule
+// (sans GL : sert aussi au rasteriseur logiciel)
+FrameUniforms sceneCamera(int count, float aspect, float time = 0.0f);
+
+// sceneCamera dans gl.frame (pris en compte au prochain renderScene)
+void uploadCamera(SceneGL& gl, int count, float aspect);
+
+// Met à jour FrameData (temps + caméra), efface puis dessine `count`
+// personnages (instancié ou une pièce = un draw ; l'instancié lit ses pièces
+// en attributs ou en texture buffer selon crowd.textureBuffer()). Avec gl.culling, seuls les
+// personnages dans le frustum de gl.frame.viewProj sont posés et dessinés ;
+// avec gl.lod, ils le sont selon leur distance à la caméra (cf. CrowdLod).
+void renderScene(SceneGL& gl, const CharacterRenderer& rig, CrowdRenderer& crowd,
+                 int count, bool instanced, float t, const AnimBlend& anim, bool paused);
+
+// Comme renderScene, mais avec des pièces déjà posées (boucle à pas fixe :
+// poses interpolées entre deux pas de simulation, cf. fixed_step.hpp).
+// gl.lod n'y a pas d'effet : l'interpolation suppose les mêmes pièces à chaque pas.
+void renderParts(SceneGL& gl, const CharacterRenderer& rig, CrowdRenderer& crowd,
+                 const PartInstance* parts, size_t n, bool instanced, float t);
+
+// Foule variée : pièces de CrowdData::pose (ordre du tri, cf.
+// CrowdPoseCache::update), palette de chaque personnage sur les deux
+// chemins, culling sur la sphère du plus grand rig
+void renderParts(SceneGL& gl, const CrowdData& varied, CrowdRenderer& crowd,
+                 const PartInstance* parts, size_t n, bool instanced, float t);
+
+#endif // SCENE_HPP
@@ -4,6 +4,19 @@
 #include <glad/glad.h>
 
 GLuint compileShader(GLenum type, const char *src);
-GLuint linkProgram(GLuint vs, GLuint fs);
+// vs / fs supprimés après le lien ; retrievable : binaire récupérable (cache)
+GLuint linkProgram(GLuint vs, GLuint fs, bool retrievable = false);
+
+// Cache disque des programmes liés (glGetProgramBinary / glProgramBinary).
+// Clé = hash des sources + GL_VENDOR / GL_RENDERER / GL_VERSION : un
+// changement de shader ou de driver retombe sur la compilation source.
+struct ProgramCacheStats {
+    int hits = 0;
+    int misses = 0; // compilé depuis les sources (absent, invalide ou refusé)
+};
+extern ProgramCacheStats g_programCache;
+
+// cacheDir == nullptr → compilation source sans cache
+GLuint buildProgram(const char *vsSrc, const char *fsSrc, const char *cacheDir);
 
 #endif
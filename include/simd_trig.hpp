@@ -0,0 +1,31 @@
+// simd_trig.hpp
+#ifndef SIMD_TRIG_HPP
+#define SIMD_TRIG_HPP
+
+#include <cstddef>
+
+// Sinus et cosinus vectorisés pour les courbes d'animation d'une foule (lots SoA).
+// Réduction de Cody-Waite sur π/2 (3 constantes) puis polynômes minimax de
+// Cephes sur [-π/4, π/4]. Erreur absolue max < 1e-7 pour |x| < 8192 rad
+// (≈ 45 min d'animation à 3 rad/s), ~1e-6 jusqu'à 65536 (cf. bench/trig_bench).
+//
+// Noyaux : AVX2 (8 voies, choisi à l'exécution), SSE2 (4), NEON (4, arm64),
+// scalaire pour le reste du lot et ailleurs. Sur x86, pas de FMA : tous les
+// noyaux donnent des résultats identiques bit à bit.
+// -DSIMD_TRIG_SCALAR force le noyau scalaire.
+
+// out[i] = sin(x[i]), i < n (x et out peuvent être le même tableau)
+void sinBatch(const float* x, float* out, size_t n);
+
+// out[i] = cos(x[i]) : même réduction, quadrant décalé de 1 (sin(x + π/2)
+// sans l'addition, donc même précision que sinBatch)
+void cosBatch(const float* x, float* out, size_t n);
+
+// Même calcul pour une valeur (noyau scalaire)
+float sinApprox(float x);
+float cosApprox(float x);
+
+// Noyau choisi pour sinBatch / cosBatch : "avx2", "sse2", "neon" ou "scalar"
+const char* trigIsa();
+
+#endif // SIMD_TRIG_HPP
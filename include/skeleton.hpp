@@ -0,0 +1,83 @@
+// skeleton.hpp
+#ifndef SKELETON_HPP
+#define SKELETON_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+#include "affine.hpp"
+
+struct RigParams;
+
+// Canaux d'animation : valeurs des courbes pour une frame (cf. evalAnim)
+enum AnimChannel { ChWalk, ChElbow, ChHip, ChKnee, ChBounce, ChSway, ChCount };
+
+struct AnimChannels {
+    float v[ChCount] = {};
+    float& operator[](int c)       { return v[c]; }
+    float  operator[](int c) const { return v[c]; }
+};
+
+// Emplacements de palette (cf. RigColors)
+enum ColorSlot { SlotHead, SlotTorso, SlotArm, SlotLeg, SlotCount };
+
+constexpr int kMaxJoints = 32;
+constexpr int kMaxParts  = 32;
+
+// Squelette "données" en SoA, articulations triées parent avant enfant :
+//   world[i] = world[parent[i]] * T(offset + transAxis * canal) * R(axis, sign * canal)
+// puis chaque pièce = world[joint] * T(center) * S(scale), sans aucune pile.
+struct Skeleton {
+    // Articulations
+    std::vector<int>       parent;       // -1 = racine (hérite de la matrice root)
+    std::vector<glm::vec3> offset;       // translation de bind dans le repère parent
+    std::vector<glm::vec3> transAxis;    // translation animée (ex. rebond)
+    std::vector<int>       transChannel; // -1 = pas de translation animée
+    std::vector<glm::vec3> axis;         // axe de rotation animée
+    std::vector<int>       rotChannel;   // -1 = pas de rotation
+    std::vector<float>     rotSign;      // angle = rotSign * canal (côté gauche/droit)
+
+    // Pièces (un cube unité chacune)
+    std::vector<int>       partJoint;
+    std::vector<glm::vec3> partCenter;   // centre du cube dans le repère de l'articulation
+    std::vector<glm::vec3> partScale;
+    std::vector<int>       partColor;    // ColorSlot
+
+    int jointCount() const { return (int)parent.size(); }
+    int partCount() const  { return (int)partJoint.size(); }
+
+    void clear();
+    int addJoint(int parentIdx, const glm::vec3& off, int rotCh = -1, float sign = 1.0f,
+                 const glm::vec3& rotAxis = {1, 0, 0});
+    void addPart(int joint, const glm::vec3& center, const glm::vec3& scale, int color);
+
+    // Passe linéaire sur les articulations (world doit contenir jointCount() matrices).
+    // Tout est affine : Affine3x4 partout (cf. affine.hpp)
+    void computeWorld(const AnimChannels& ch, const Affine3x4& root, Affine3x4* world) const;
+    // Idem depuis une pose locale échantillonnée (cf. AnimClip) :
+    //   world[i] = world[parent[i]] * T(offset + trans[i]) * R(rot[i])
+    void computeWorldLocal(const glm::quat* rot, const glm::vec3* trans, const Affine3x4& root,
+                           Affine3x4* world) const;
+    // Matrice model de chaque pièce (models doit contenir partCount() matrices)
+    void computeParts(const Affine3x4* world, Affine3x4* models) const;
+
+    // Rayon d'une sphère centrée sur l'articulation 0 (seule racine) contenant
+    // toutes les pièces quelles que soient les rotations : longueurs des
+    // chaînes + demi-diagonale de chaque pièce. Les translations animées des
+    // autres articulations comptent pour maxTrans chacune.
+    float boundRadius(float maxTrans) const;
+
+    // Octets alloués par les tableaux (capacités, hors sizeof(Skeleton))
+    size_t heapBytes() const;
+};
+
+// L'humanoïde du sujet, exprimé en données à partir des tailles.
+// Remplit `out` en place (les capacités sont réutilisées d'un appel à l'autre).
+void buildHumanoid(const RigParams& p, Skeleton& out);
+
+// Version basse résolution (LOD, cf. crowd_lod.hpp) : avant-bras fusionné dans
+// le bras et tibia dans la cuisse (membres tendus, coudes et genoux ignorés),
+// 5 articulations et 6 pièces au lieu de 9 et 10. Mêmes canaux d'animation.
+void buildHumanoidMerged(const RigParams& p, Skeleton& out);
+
+#endif // SKELETON_HPP
@@ -0,0 +1,82 @@
+// soft_raster.hpp
+#ifndef SOFT_RASTER_HPP
+#define SOFT_RASTER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "character.hpp"
+
+class JobSystem;
+
+// Tuiles carrées de kSoftTile pixels (unité de parallélisme et de binning)
+constexpr int kSoftTile = 64;
+// Bande de garde en entiers 32 bits : largeur / hauteur max du framebuffer
+constexpr int kSoftMaxSize = 4096;
+
+// Framebuffer en mémoire : RGBA8 (octets R, G, B, A) + profondeur [0, 1].
+// Ligne 0 = bas de l'image, comme glReadPixels. Le stockage est arrondi à
+// des tuiles entières (stride) pour que chaque tuile soit indépendante.
+struct SoftFramebuffer {
+    int width = 0, height = 0;
+    int stride = 0; // en pixels
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+
+    void resize(int w, int h);
+    // Copie compacte width * height (même disposition que glReadPixels RGBA)
+    void readPixels(std::vector<uint32_t>& out) const;
+};
+
+// Backend CPU pour machines sans GPU : mêmes entrées que le chemin instancié
+// (PartInstance = matrice model + couleur de la pièce), rastérise les 12
+// triangles du cube unité par pièce.
+//   1. setup par tranches de pièces (JobSystem) : rejet frustum, faces
+//      arrière, clipping near / bande de garde, demi-espaces en virgule fixe
+//      (4 bits de sous-pixel, règle top-left) ;
+//   2. binning des triangles par tuile ;
+//   3. une tuile = un job : clear puis rastérisation SIMD (AVX2, SSE2 ou
+//      scalaire selon le CPU, -DSOFT_RASTER_SCALAR pour forcer) avec test
+//      de profondeur LESS ; les trois donnent la même image.
+// Différences avec GL : faces arrière rejetées (cubes fermés, caméra hors des
+// pièces) et précision sous-pixel plus faible, d'où une tolérance en validation.
+class SoftRasterizer {
+public:
+    SoftRasterizer();
+
+    SoftRasterizer(const SoftRasterizer&) = delete;
+    SoftRasterizer& operator=(const SoftRasterizer&) = delete;
+
+    void setJobs(JobSystem* jobs) { jobs_ = jobs; }
+
+    // "avx2", "sse2" ou "scalar"
+    const char* isa() const { return isa_; }
+
+    // Efface fb (clearColor, profondeur 1) puis dessine les n pièces
+    void render(const PartInstance* parts, size_t n, const glm::mat4& viewProj,
+                const glm::vec4& clearColor, SoftFramebuffer& fb);
+
+    // Triangle prêt à rastériser : E_i(x, y) = A*x + B*y + C >= 0 à l'intérieur,
+    // x, y en 1/16 de pixel ; z = profondeur au centre du pixel (x0, y0)
+    struct Tri {
+        int x0, y0, x1, y1; // boîte englobante en pixels (incluse, dans l'écran)
+        int32_t A[3], B[3];
+        int64_t C[3];
+        float z, zdx, zdy;
+        uint32_t color;
+    };
+    struct Span;
+    using SpanKernel = void (*)(const Span&, SoftFramebuffer&);
+
+private:
+    void rasterTile(int tile, uint32_t clear, SoftFramebuffer& fb) const;
+
+    JobSystem* jobs_ = nullptr;
+    SpanKernel kernel_ = nullptr;
+    const char* isa_ = "scalar";
+    int tilesX_ = 0, tilesY_ = 0;
+    std::vector<std::vector<Tri>> chunks_;        // triangles, une liste par tranche de pièces
+    std::vector<std::vector<const Tri*>> bins_;   // triangles par tuile, ordre de soumission
+};
+
+#endif // SOFT_RASTER_HPP
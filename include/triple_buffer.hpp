@@ -0,0 +1,42 @@
+// triple_buffer.hpp
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+// Triple buffer sans verrou, un producteur / un consommateur : le producteur
+// remplit writeBuffer() puis publish() ; le consommateur prend le dernier
+// instantané publié avec acquire() et lit readBuffer(). Aucun des deux
+// n'attend l'autre ; un instantané non lu est remplacé par le suivant.
+// Les slots ne sont jamais partagés : le producteur a le sien, le
+// consommateur le sien, le troisième (middle_) est l'échange.
+template <class T>
+class TripleBuffer {
+public:
+    // Producteur
+    T& writeBuffer() { return slots_[back_]; }
+    void publish() { back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex; }
+    // Vrai tant que le dernier publish() n'a pas été pris par acquire()
+    bool pending() const { return middle_.load(std::memory_order_acquire) & kFresh; }
+
+    // Consommateur : true si un nouvel instantané a été pris
+    bool acquire()
+    {
+        if (!pending())
+            return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    const T& readBuffer() const { return slots_[front_]; }
+
+private:
+    static constexpr int kIndex = 3;
+    static constexpr int kFresh = 4;
+
+    T slots_[3];
+    int back_ = 0;
+    int front_ = 1;
+    std::atomic<int> middle_{2};
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -0,0 +1,24 @@
+#version 410 core
+#ifdef PROCEDURAL_CUBE
+// Mêmes 12 triangles que make_unit_cube, coins générés depuis gl_VertexID
+const int kCubeIdx[36] = int[36](0, 1, 2, 2, 3, 0,  4, 5, 6, 6, 7, 4,  0, 4, 7, 7, 3, 0,
+                                 1, 5, 6, 6, 2, 1,  3, 2, 6, 6, 7, 3,  0, 1, 5, 5, 4, 0);
+vec3 cubeCorner(int c) { return vec3(((c + 1) >> 1) & 1, (c >> 1) & 1, (c >> 2) & 1) - 0.5; }
+#define CUBE_POS cubeCorner(kCubeIdx[gl_VertexID])
+#else
+layout (location = 0) in vec3 aPos;
+#define CUBE_POS aPos
+#endif
+layout (location = 1) in mat3x4 iModel; // locations 1..3 (lignes de l'Affine3x4)
+layout (location = 4) in vec4 iColor;
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 time;
+};
+out vec4 vColor;
+void main() {
+    vColor = iColor;
+    gl_Position = viewProj * vec4(vec4(CUBE_POS, 1.0) * iModel, 1.0);
+}
@@ -1,8 +1,34 @@
 #version 410 core
+#ifdef PROCEDURAL_CUBE
+// Mêmes 12 triangles que make_unit_cube, coins générés depuis gl_VertexID
+const int kCubeIdx[36] = int[36](0, 1, 2, 2, 3, 0,  4, 5, 6, 6, 7, 4,  0, 4, 7, 7, 3, 0,
+                                 1, 5, 6, 6, 2, 1,  3, 2, 6, 6, 7, 3,  0, 1, 5, 5, 4, 0);
+vec3 cubeCorner(int c) { return vec3(((c + 1) >> 1) & 1, (c >> 1) & 1, (c >> 2) & 1) - 0.5; }
+#define CUBE_POS cubeCorner(kCubeIdx[gl_VertexID])
+#else
 layout (location = 0) in vec3 aPos;
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#define CUBE_POS aPos
+#endif
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 time;
+};
+#ifdef TBO_INSTANCES
+// Foule en un draw sans attribut d'instance : les PartInstance de la frame
+// dans un texture buffer RGBA32F, 4 texels chacune (3 lignes + couleur)
+uniform samplerBuffer uInstances;
+out vec4 vColor;
+#else
+uniform mat3x4 model; // Affine3x4 : colonnes = lignes de la transformation
+#endif
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+#ifdef TBO_INSTANCES
+    int base = gl_InstanceID * 4;
+    mat3x4 model = mat3x4(texelFetch(uInstances, base), texelFetch(uInstances, base + 1),
+                          texelFetch(uInstances, base + 2));
+    vColor = texelFetch(uInstances, base + 3);
+#endif
+    gl_Position = viewProj * vec4(vec4(CUBE_POS, 1.0) * model, 1.0);
+}
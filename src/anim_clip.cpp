@@ -0,0 +1,316 @@
+// anim_clip.cpp
+#include "anim_clip.hpp"
+#include <algorithm>
+#include <cmath>
+
+float animPeriod(AnimMode mode)
+{
+    // Oscillation du torse : sin(0.7 t), période 2π/0.7.
+    // Walk : sin(2 t) (π), Jump : sin(3 t) (2π/3) → PPCM avec 2π/0.7 = 20π.
+    const float pi = 3.14159265358979f;
+    return mode == AnimMode::Idle ? 2.0f * pi / 0.7f : 20.0f * pi;
+}
+
+AnimClip bakeClip(const Skeleton &s, AnimMode mode, float rate)
+{
+    AnimClip c;
+    c.rate = rate;
+    c.duration = animPeriod(mode);
+    c.jointCount = s.jointCount();
+    c.keyCount = std::max(1, (int)std::lround(c.duration * rate));
+    c.rate = c.keyCount / c.duration; // clés réparties exactement sur la période
+    c.rot.resize((size_t)c.keyCount * c.jointCount);
+    c.trans.resize((size_t)c.keyCount * c.jointCount);
+
+    for (int k = 0; k < c.keyCount; ++k)
+    {
+        const AnimChannels ch = evalAnim(mode, k / c.rate);
+        glm::quat *rot = &c.rot[(size_t)k * c.jointCount];
+        glm::vec3 *trans = &c.trans[(size_t)k * c.jointCount];
+        for (int j = 0; j < c.jointCount; ++j)
+        {
+            const float angle = s.rotChannel[j] >= 0 ? s.rotSign[j] * ch[s.rotChannel[j]] : 0.0f;
+            rot[j] = glm::angleAxis(angle, s.axis[j]);
+            trans[j] = s.transChannel[j] >= 0 ? s.transAxis[j] * ch[s.transChannel[j]] : glm::vec3(0.0f);
+        }
+    }
+    return c;
+}
+
+// Clés encadrant t (bouclé, t négatif compris) et fraction entre les deux
+static void keyPair(float rate, int keyCount, float t, int &k0, int &k1, float &a)
+{
+    float u = t * rate;
+    u -= std::floor(u / keyCount) * keyCount;
+    k0 = std::min(std::max((int)u, 0), keyCount - 1);
+    k1 = (k0 + 1 == keyCount) ? 0 : k0 + 1;
+    a = u - k0;
+}
+
+// nlerp : clés rapprochées → écart à slerp négligeable, sans acos/sin
+static inline glm::quat nlerp(const glm::quat &q0, const glm::quat &q1, float a)
+{
+    const float sign = glm::dot(q0, q1) < 0.0f ? -a : a;
+    const glm::quat q = q0 * (1.0f - a) + q1 * sign;
+    return q * (1.0f / std::sqrt(glm::dot(q, q)));
+}
+
+void sampleClip(const AnimClip &c, float t, glm::quat *rot, glm::vec3 *trans)
+{
+    int k0, k1;
+    float a;
+    keyPair(c.rate, c.keyCount, t, k0, k1, a);
+
+    const glm::quat *r0 = &c.rot[(size_t)k0 * c.jointCount];
+    const glm::quat *r1 = &c.rot[(size_t)k1 * c.jointCount];
+    const glm::vec3 *t0 = &c.trans[(size_t)k0 * c.jointCount];
+    const glm::vec3 *t1 = &c.trans[(size_t)k1 * c.jointCount];
+    for (int j = 0; j < c.jointCount; ++j)
+    {
+        rot[j] = nlerp(r0[j], r1[j], a);
+        trans[j] = t0[j] + (t1[j] - t0[j]) * a;
+    }
+}
+
+void bakeLibrary(const Skeleton &s, float rate, AnimLibrary &out)
+{
+    for (AnimMode m : {AnimMode::Idle, AnimMode::Walk, AnimMode::Jump})
+        out.clips[(int)m] = bakeClip(s, m, rate);
+    out.compressed = false;
+}
+
+// ---------------------- Compression ----------------------
+
+// Hors la plus grande, |composante| ≤ 1/√2 ; 15 bits sur cet intervalle
+static const float kQuatRange = 0.70710678f;
+static const float kQuatStep = 2.0f * kQuatRange / 32767.0f;
+
+// Écart au-dessous duquel une piste est constante (bien sous les pas de quantification)
+static const float kConstEps = 1e-6f;
+
+static void encodeQuat(const glm::quat &q, uint16_t *out)
+{
+    const float c[4] = {q.x, q.y, q.z, q.w};
+    int largest = 0;
+    for (int i = 1; i < 4; ++i)
+        if (std::fabs(c[i]) > std::fabs(c[largest]))
+            largest = i;
+    const float sign = c[largest] < 0.0f ? -1.0f : 1.0f; // q ≡ -q : la plus grande devient positive
+    uint64_t bits = (uint64_t)largest << 45;
+    for (int i = 0, k = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        const float v = std::min(std::max(c[i] * sign, -kQuatRange), kQuatRange);
+        bits |= (uint64_t)std::lround((v + kQuatRange) / kQuatStep) << (15 * k++);
+    }
+    out[0] = (uint16_t)bits;
+    out[1] = (uint16_t)(bits >> 16);
+    out[2] = (uint16_t)(bits >> 32);
+}
+
+// Les 3 composantes stockées et l'indice (x, y, z, w) de la reconstruite
+struct SmallestThree {
+    float a, b, c;
+    int largest;
+};
+
+static inline SmallestThree unpackQuat(const uint16_t *w)
+{
+    const uint64_t bits = w[0] | (uint64_t)w[1] << 16 | (uint64_t)w[2] << 32;
+    return SmallestThree{(float)(bits & 0x7FFF) * kQuatStep - kQuatRange,
+                         (float)((bits >> 15) & 0x7FFF) * kQuatStep - kQuatRange,
+                         (float)((bits >> 30) & 0x7FFF) * kQuatStep - kQuatRange, (int)(bits >> 45) & 3};
+}
+
+// Reconstruit la plus grande composante et la réinsère à sa place ; quasi
+// toujours la même pour une articulation donnée : branche bien prédite
+static inline glm::quat assembleQuat(float a, float b, float c, int largest)
+{
+    const float d = std::sqrt(std::max(0.0f, 1.0f - a * a - b * b - c * c));
+    switch (largest)
+    {
+    case 0:
+        return glm::quat(c, d, a, b);
+    case 1:
+        return glm::quat(c, a, d, b);
+    case 2:
+        return glm::quat(c, a, b, d);
+    default:
+        return glm::quat(d, a, b, c);
+    }
+}
+
+// Plus grand écart de composante, au signe près (q ≡ -q)
+static float quatDiff(const glm::quat &a, const glm::quat &b)
+{
+    float same = 0.0f, opposite = 0.0f;
+    for (int i = 0; i < 4; ++i)
+    {
+        same = std::max(same, std::fabs(a[i] - b[i]));
+        opposite = std::max(opposite, std::fabs(a[i] + b[i]));
+    }
+    return std::min(same, opposite);
+}
+
+CompressedClip compressClip(const AnimClip &c)
+{
+    CompressedClip z;
+    z.rate = c.rate;
+    z.duration = c.duration;
+    z.jointCount = c.jointCount;
+    z.keyCount = c.keyCount;
+
+    // Pistes : constantes (valeur de la clé 0) ou animées (bornes des translations)
+    const int joints = c.jointCount;
+    for (int j = 0; j < joints; ++j)
+    {
+        z.constRot[j] = c.rot[j];
+        z.constTrans[j] = c.trans[j];
+        bool rotAnimated = false;
+        glm::vec3 tlo = c.trans[j], thi = c.trans[j];
+        for (int k = 1; k < c.keyCount; ++k)
+        {
+            rotAnimated |= quatDiff(c.rot[(size_t)k * joints + j], c.rot[j]) > kConstEps;
+            tlo = glm::min(tlo, c.trans[(size_t)k * joints + j]);
+            thi = glm::max(thi, c.trans[(size_t)k * joints + j]);
+        }
+        if (rotAnimated)
+            z.rotTracks.push_back((uint8_t)j);
+        const glm::vec3 extent = thi - tlo;
+        if (std::max(extent.x, std::max(extent.y, extent.z)) > kConstEps)
+        {
+            z.transTracks.push_back((uint8_t)j);
+            z.transMin.push_back(tlo);
+            z.transStep.push_back(extent / 65535.0f);
+        }
+    }
+
+    const int words = z.keyWords();
+    z.keys.resize((size_t)c.keyCount * words);
+    for (int k = 0; k < c.keyCount; ++k)
+    {
+        uint16_t *w = &z.keys[(size_t)k * words];
+        for (uint8_t j : z.rotTracks)
+        {
+            encodeQuat(c.rot[(size_t)k * joints + j], w);
+            w += 3;
+        }
+        for (size_t i = 0; i < z.transTracks.size(); ++i)
+        {
+            const glm::vec3 v = c.trans[(size_t)k * joints + z.transTracks[i]];
+            for (int a = 0; a < 3; ++a)
+            {
+                const float step = z.transStep[i][a];
+                *w++ = step > 0.0f ? (uint16_t)std::lround((v[a] - z.transMin[i][a]) / step) : 0;
+            }
+        }
+    }
+    return z;
+}
+
+void sampleCompressed(const CompressedClip &c, float t, glm::quat *rot, glm::vec3 *trans)
+{
+    std::copy(c.constRot, c.constRot + c.jointCount, rot);
+    std::copy(c.constTrans, c.constTrans + c.jointCount, trans);
+    const int words = c.keyWords();
+    if (words == 0)
+        return;
+
+    int k0, k1;
+    float a;
+    keyPair(c.rate, c.keyCount, t, k0, k1, a);
+    const uint16_t *w0 = &c.keys[(size_t)k0 * words];
+    const uint16_t *w1 = &c.keys[(size_t)k1 * words];
+    for (uint8_t j : c.rotTracks)
+    {
+        const SmallestThree q0 = unpackQuat(w0), q1 = unpackQuat(w1);
+        if (q0.largest == q1.largest)
+            // Même composante reconstruite aux deux clés (cas courant) : on
+            // interpole les 3 stockées et on reconstruit une seule fois. Reste
+            // unitaire ; l'écart à nlerp est du même ordre que celui de nlerp à slerp.
+            rot[j] = assembleQuat(q0.a + (q1.a - q0.a) * a, q0.b + (q1.b - q0.b) * a, q0.c + (q1.c - q0.c) * a,
+                                  q0.largest);
+        else
+            rot[j] = nlerp(assembleQuat(q0.a, q0.b, q0.c, q0.largest), assembleQuat(q1.a, q1.b, q1.c, q1.largest), a);
+        w0 += 3;
+        w1 += 3;
+    }
+    for (size_t i = 0; i < c.transTracks.size(); ++i)
+    {
+        const glm::vec3 u0(w0[0], w0[1], w0[2]), u1(w1[0], w1[1], w1[2]);
+        trans[c.transTracks[i]] = c.transMin[i] + (u0 + (u1 - u0) * a) * c.transStep[i];
+        w0 += 3;
+        w1 += 3;
+    }
+}
+
+size_t AnimLibrary::bytes() const
+{
+    size_t n = 0;
+    for (int m = 0; m < 3; ++m)
+        n += compressed ? packed[m].bytes() : clips[m].bytes();
+    return n;
+}
+
+void compressLibrary(AnimLibrary &lib)
+{
+    for (int m = 0; m < 3; ++m)
+    {
+        lib.packed[m] = compressClip(lib.clips[m]);
+        lib.clips[m] = AnimClip();
+    }
+    lib.compressed = true;
+}
+
+void sampleLibrary(const AnimLibrary &lib, AnimMode mode, float t, glm::quat *rot, glm::vec3 *trans)
+{
+    if (lib.compressed)
+        sampleCompressed(lib.packed[(int)mode], t, rot, trans);
+    else
+        sampleClip(lib[mode], t, rot, trans);
+}
+
+void sampleBlend(const AnimLibrary &lib, const Skeleton &s, const AnimBlend &b, float t, glm::quat *rot,
+                 glm::vec3 *trans)
+{
+    sampleLibrary(lib, b.source[0].clip, t * b.source[0].speed, rot, trans);
+    if (b.count == 1 && b.layers == 0)
+        return;
+
+    const int n = s.jointCount();
+    glm::quat r[kMaxJoints];
+    glm::vec3 tr[kMaxJoints];
+    if (b.count > 1)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            rot[j] = rot[j] * b.weight[0];
+            trans[j] = trans[j] * b.weight[0];
+        }
+        for (int k = 1; k < b.count; ++k)
+        {
+            sampleLibrary(lib, b.source[k].clip, t * b.source[k].speed, r, tr);
+            for (int j = 0; j < n; ++j)
+            {
+                // Même hémisphère que la somme partielle (q et -q : même rotation)
+                const float w = glm::dot(rot[j], r[j]) < 0.0f ? -b.weight[k] : b.weight[k];
+                rot[j] = rot[j] + r[j] * w;
+                trans[j] = trans[j] + tr[j] * b.weight[k];
+            }
+        }
+        for (int j = 0; j < n; ++j)
+            rot[j] = rot[j] * (1.0f / std::sqrt(glm::dot(rot[j], rot[j])));
+    }
+
+    const glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+    for (int k = 0; k < b.layers; ++k)
+    {
+        const AnimLayer &l = b.layer[k];
+        sampleLibrary(lib, l.source.clip, t * l.source.speed, r, tr);
+        // Seul ChBounce anime une translation, et les couches l'ignorent
+        for (int j = 0; j < n; ++j)
+            if (s.rotChannel[j] >= 0 && (l.mask >> s.rotChannel[j] & 1))
+                rot[j] = rot[j] * nlerp(identity, r[j], l.weight);
+    }
+}
@@ -0,0 +1,132 @@
+// anim_graph.cpp
+#include "anim_graph.hpp"
+#include <algorithm>
+
+// ---------------------- Graphe ----------------------
+
+AnimGraph::AnimGraph()
+{
+    addState("idle", AnimSource{AnimMode::Idle, 1.0f});
+    addState("walk", AnimSource{AnimMode::Walk, 1.0f});
+    addState("jump", AnimSource{AnimMode::Jump, 1.0f});
+}
+
+int AnimGraph::addState(const std::string &name, const AnimSource &source)
+{
+    states_.push_back(AnimState{name, source});
+    return (int)states_.size() - 1;
+}
+
+int AnimGraph::find(const std::string &name) const
+{
+    for (size_t i = 0; i < states_.size(); ++i)
+        if (states_[i].name == name)
+            return (int)i;
+    return -1;
+}
+
+void AnimGraph::setFade(int from, int to, float seconds)
+{
+    for (Fade &f : fades_)
+        if (f.from == from && f.to == to)
+        {
+            f.seconds = seconds;
+            return;
+        }
+    fades_.push_back(Fade{from, to, seconds});
+}
+
+float AnimGraph::fade(int from, int to) const
+{
+    // Paire exacte d'abord, puis "depuis n'importe quel état"
+    float any = defaultFade;
+    for (const Fade &f : fades_)
+    {
+        if (f.to != to)
+            continue;
+        if (f.from == from)
+            return f.seconds;
+        if (f.from == -1)
+            any = f.seconds;
+    }
+    return any;
+}
+
+// ---------------------- Lecture ----------------------
+
+AnimPlayer::AnimPlayer(const AnimGraph &graph, int state) : graph_(&graph)
+{
+    stack_[0] = Entry{state, 0.0f, 0.0f};
+    depth_ = 1;
+}
+
+float AnimPlayer::coverage(int i, float t) const
+{
+    const Entry &e = stack_[i];
+    if (i == 0)
+        return 1.0f; // le fond prend tout ce qui reste
+    if (e.duration <= 0.0f)
+        return t >= e.start ? 1.0f : 0.0f;
+    const float a = std::min(std::max((t - e.start) / e.duration, 0.0f), 1.0f);
+    return a * a * (3.0f - 2.0f * a);
+}
+
+void AnimPlayer::play(int state, float t)
+{
+    const int from = this->state();
+    if (state == from)
+        return;
+
+    // Entrées entièrement recouvertes à t (fondu au-dessus terminé) : retirées
+    int bottom = 0;
+    for (int i = depth_ - 1; i > 0; --i)
+        if (coverage(i, t) >= 1.0f)
+        {
+            bottom = i;
+            break;
+        }
+    // Pile pleine : la plus ancienne part, sa part revient à la suivante
+    if (depth_ - bottom == kMaxBlend)
+        ++bottom;
+    std::copy(stack_ + bottom, stack_ + depth_, stack_);
+    depth_ -= bottom;
+
+    stack_[depth_++] = Entry{state, t, graph_->fade(from, state)};
+}
+
+void AnimPlayer::setLayer(int slot, int state, float weight, uint32_t mask)
+{
+    layerState_[slot] = state;
+    layerWeight_[slot] = weight;
+    layerMask_[slot] = mask;
+}
+
+AnimBlend AnimPlayer::blend(float t) const
+{
+    AnimBlend b;
+    b.count = 0;
+    float remaining = 1.0f;
+    for (int i = depth_ - 1; i >= 0 && remaining > 0.0f; --i)
+    {
+        const float w = remaining * coverage(i, t);
+        remaining -= w;
+        if (w <= 0.0f)
+            continue;
+        // Même état deux fois dans la pile (aller-retour) : une seule source
+        const AnimSource &src = graph_->state(stack_[i].state).source;
+        int k = 0;
+        while (k < b.count && (b.source[k].clip != src.clip || b.source[k].speed != src.speed))
+            ++k;
+        if (k == b.count)
+        {
+            b.source[b.count] = src;
+            b.weight[b.count++] = 0.0f;
+        }
+        b.weight[k] += w;
+    }
+
+    for (int k = 0; k < kMaxLayers; ++k)
+        if (layerWeight_[k] > 0.0f)
+            b.layer[b.layers++] = AnimLayer{graph_->state(layerState_[k]).source, layerWeight_[k], layerMask_[k]};
+    return b;
+}
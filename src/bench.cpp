@@ -0,0 +1,955 @@
+// bench.cpp
+#include "bench.hpp"
+#include "anim_clip.hpp"
+#include "crowd_data.hpp"
+#include "gl_state.hpp"
+#include "gl_stats.hpp"
+#include "headless.hpp"
+#include "helper.hpp"
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include "scene.hpp"
+#include "shader_utils.hpp"
+#include "soft_raster.hpp"
+#include "triple_buffer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// ---------------------- Arguments ----------------------
+
+static const char *const kModeNames[] = {"idle", "walk", "jump"};
+
+// "walk", ou "walk+jump" pour un mélange
+static std::string modeName(const AnimBlend &b)
+{
+    std::string name;
+    for (int k = 0; k < b.count; ++k)
+        name += std::string(k ? "+" : "") + kModeNames[(int)b.source[k].clip];
+    return name;
+}
+
+// "walk" ou "walk+jump[+...]" : sources à poids égaux
+static bool parseMode(const char *v, AnimBlend &out)
+{
+    out.count = 0;
+    for (const char *p = v; *p;)
+    {
+        const size_t len = std::strcspn(p, "+");
+        int m = 0;
+        while (m < 3 && (std::strlen(kModeNames[m]) != len || std::strncmp(p, kModeNames[m], len)))
+            ++m;
+        if (m == 3 || out.count == kMaxBlend)
+            return false;
+        out.source[out.count++].clip = (AnimMode)m;
+        p += p[len] ? len + 1 : len;
+    }
+    for (int k = 0; k < out.count; ++k)
+        out.weight[k] = 1.0f / out.count;
+    return out.count > 0;
+}
+
+bool parseBenchArgs(int argc, char **argv, BenchOptions &o)
+{
+    static const char *const withValue[] = {"--frames", "--warmup", "--count", "--threads", "--json", "--size", "--mode",
+                                             "--shader-cache", "--baked", "--cube", "--raster", "--ppm",
+                                             "--validate", "--camera", "--profile", "--capture", "--capture-pipe",
+                                             "--capture-depth"};
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        if (!std::strcmp(a, "--bench"))
+        {
+            o.enabled = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--instanced"))
+        {
+            o.instanced = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--render-thread"))
+        {
+            o.renderThread = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--no-cull"))
+        {
+            o.culling = false;
+            continue;
+        }
+        if (!std::strcmp(a, "--lod"))
+        {
+            o.lod = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--paused"))
+        {
+            o.paused = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--variety"))
+        {
+            o.variety = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--compressed"))
+        {
+            o.compressed = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--tbo"))
+        {
+            o.instanced = o.tbo = true;
+            continue;
+        }
+        if (!std::strcmp(a, "--capture-drop"))
+        {
+            o.capture.dropWhenFull = true;
+            continue;
+        }
+
+        const bool known = std::any_of(std::begin(withValue), std::end(withValue),
+                                       [&](const char *f)
+                                       { return !std::strcmp(a, f); });
+        if (!known)
+        {
+            std::cerr << "Unknown argument: " << a << "\n";
+            return false;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << a << ": missing value\n";
+            return false;
+        }
+        const char *v = argv[++i];
+
+        if (!std::strcmp(a, "--frames"))
+            o.frames = std::max(1, std::atoi(v));
+        else if (!std::strcmp(a, "--warmup"))
+            o.warmup = std::max(0, std::atoi(v));
+        else if (!std::strcmp(a, "--count"))
+            o.count = std::max(1, std::atoi(v));
+        else if (!std::strcmp(a, "--camera"))
+            o.cameraCount = std::max(1, std::atoi(v));
+        else if (!std::strcmp(a, "--threads"))
+            o.threads = std::max(0, std::atoi(v));
+        else if (!std::strcmp(a, "--json"))
+            o.json = v;
+        else if (!std::strcmp(a, "--shader-cache"))
+            o.shaderCache = v;
+        else if (!std::strcmp(a, "--baked"))
+            o.bakedRate = std::max(0.0f, (float)std::atof(v));
+        else if (!std::strcmp(a, "--cube"))
+        {
+            if (std::strcmp(v, "buffered") && std::strcmp(v, "procedural"))
+            {
+                std::cerr << "--cube: expected buffered or procedural\n";
+                return false;
+            }
+            o.proceduralCube = !std::strcmp(v, "procedural");
+        }
+        else if (!std::strcmp(a, "--raster"))
+        {
+            if (std::strcmp(v, "gl") && std::strcmp(v, "soft"))
+            {
+                std::cerr << "--raster: expected gl or soft\n";
+                return false;
+            }
+            o.softRaster = !std::strcmp(v, "soft");
+        }
+        else if (!std::strcmp(a, "--ppm"))
+            o.ppm = v;
+        else if (!std::strcmp(a, "--capture"))
+            o.capture.pattern = v;
+        else if (!std::strcmp(a, "--capture-pipe"))
+            o.capture.pipe = v;
+        else if (!std::strcmp(a, "--capture-depth"))
+            o.capture.depth = std::max(0, std::atoi(v));
+        else if (!std::strcmp(a, "--profile"))
+        {
+            if (!prof::kEnabled)
+            {
+                std::cerr << "--profile: profiler not built in (make re PROFILE=1)\n";
+                return false;
+            }
+            o.profile = v;
+        }
+        else if (!std::strcmp(a, "--validate"))
+            o.validate = std::max(0.0f, (float)std::atof(v));
+        else if (!std::strcmp(a, "--size"))
+        {
+            if (std::sscanf(v, "%dx%d", &o.width, &o.height) != 2 || o.width <= 0 || o.height <= 0)
+            {
+                std::cerr << "--size: expected WxH\n";
+                return false;
+            }
+        }
+        else if (!parseMode(v, o.mode))
+        {
+            std::cerr << "--mode: expected idle, walk or jump, or up to 4 joined by '+'\n";
+            return false;
+        }
+    }
+    if (o.capture.enabled() && o.softRaster)
+    {
+        std::cerr << "--capture: GL raster only\n";
+        return false;
+    }
+    if (o.variety && o.bakedRate > 0.0f)
+    {
+        std::cerr << "--variety: analytic curves only (clips are baked for one skeleton)\n";
+        return false;
+    }
+    return true;
+}
+
+// ---------------------- Statistiques ----------------------
+
+struct FrameStats {
+    double min = 0, mean = 0, p50 = 0, p95 = 0, p99 = 0, max = 0;
+};
+
+static FrameStats summarize(std::vector<double> ms)
+{
+    FrameStats s;
+    if (ms.empty())
+        return s;
+    std::sort(ms.begin(), ms.end());
+    auto pct = [&](double q)
+    { return ms[std::min(ms.size() - 1, (size_t)(q * (ms.size() - 1) + 0.5))]; };
+    double sum = 0;
+    for (double v : ms)
+        sum += v;
+    s.min = ms.front();
+    s.max = ms.back();
+    s.mean = sum / ms.size();
+    s.p50 = pct(0.50);
+    s.p95 = pct(0.95);
+    s.p99 = pct(0.99);
+    return s;
+}
+
+static void printStats(std::ostream &os, const char *name, const FrameStats &s)
+{
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "%-6s min %8.3f  mean %8.3f  p50 %8.3f  p95 %8.3f  p99 %8.3f  max %8.3f ms\n",
+                  name, s.min, s.mean, s.p50, s.p95, s.p99, s.max);
+    os << buf;
+}
+
+// Chaîne du driver (GL_RENDERER, GL_VERSION) : guillemets, antislashs et
+// caractères de contrôle échappés
+static std::string jsonString(const std::string &s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+            out += buf;
+        }
+        else
+            out += c;
+    }
+    return out + "\"";
+}
+
+static void jsonStats(std::ostream &os, const FrameStats &s)
+{
+    os << "{\"min\": " << s.min << ", \"mean\": " << s.mean << ", \"p50\": " << s.p50
+       << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+}
+
+// ---------------------- Boucle ----------------------
+
+// Résultat d'un backend, pour l'affichage texte / JSON
+struct BenchRun {
+    std::string renderer, version;
+    double startupMs = 0;
+    unsigned threads = 0;
+    FrameStats cpu, frame, latency;
+    double fps = 0;
+    GLCallStats calls;
+    CommandStats unsorted, sorted; // chemin une pièce = un draw, cumulés sur les frames mesurées
+    CullStats cull;                // cumulés sur les frames mesurées
+    double animMs = 0;             // poses (CrowdCuller::build), cumulées
+    LodStats lod;                  // cumulés
+    int redrawn = 0;               // frames mesurées réellement rendues (--paused : les autres sont sautées)
+    double processCpuMs = 0;       // temps CPU du processus (tous threads) sur les frames mesurées
+    double uploadMs = 0;           // uploads des pièces du chemin instancié, cumulés
+    CaptureStats capture;          // --capture
+    std::vector<uint32_t> lastFrame; // RGBA, ligne 0 = bas (si --ppm)
+};
+
+static void setupRig(const BenchOptions &opt, CharacterRenderer &rig, AnimLibrary &baked)
+{
+    if (opt.bakedRate > 0.0f)
+    {
+        bakeLibrary(rig.skeleton(), opt.bakedRate, baked);
+        if (opt.compressed)
+            compressLibrary(baked);
+        rig.setBaked(&baked);
+    }
+}
+
+// --variety : mêmes racines que crowdRoot ; l'entrée 0 des mélanges (les
+// marcheurs) prend --mode. Triée ici : loopThreaded la lit ensuite depuis
+// deux threads sans la modifier.
+static void setupVariety(const BenchOptions &opt, CrowdData &varied)
+{
+    populateCrowd(varied, opt.count);
+    varied.setBlend(0, opt.mode);
+    varied.sort();
+}
+
+// Foule cadrée par la caméra (--camera)
+static int cameraCount(const BenchOptions &opt)
+{
+    return opt.cameraCount > 0 ? opt.cameraCount : opt.count;
+}
+
+// Horloge déterministe : frame f (négative pendant le warmup) → temps
+static float benchTime(const BenchOptions &opt, int f)
+{
+    return (f + opt.warmup) / 60.0f;
+}
+
+static void readPixelsGL(const BenchOptions &opt, std::vector<uint32_t> &out)
+{
+    out.resize((size_t)opt.width * opt.height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, opt.width, opt.height, GL_RGBA, GL_UNSIGNED_BYTE, out.data());
+}
+
+static double msSince(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Un thread : poses + soumission + glFinish à la suite.
+// cpu = poses + soumission GL ; frame = latence = cpu + glFinish (rendu complet)
+// Foule variée : poses de toute la foule (CrowdPoseCache) puis renderParts.
+static void loopSingle(const BenchOptions &opt, SceneGL &gl, const CharacterRenderer &rig, CrowdData *varied,
+                       CrowdRenderer &crowd, FrameCapture *capture, BenchRun &run)
+{
+    std::vector<double> cpuMs, frameMs;
+    cpuMs.reserve(opt.frames);
+    frameMs.reserve(opt.frames);
+
+    using clock = std::chrono::steady_clock;
+    clock::time_point start;
+    std::clock_t cpuStart = 0;
+    PoseKey shown; // pose de l'image dans le framebuffer (caméra fixe)
+    CrowdPoseCache variedPoses;
+    for (int f = -opt.warmup; f < opt.frames; ++f)
+    {
+        const float t = benchTime(opt, f);
+        prof::gpuFrame();
+        prof::endFrame();
+        if (f == 0)
+        {
+            g_glStats.reset();
+            if (!opt.profile.empty())
+                prof::startCapture();
+            start = clock::now();
+            cpuStart = std::clock();
+        }
+
+        // Redessin à la demande : même pose que l'image affichée → rien à faire
+        const auto t0 = clock::now();
+        double poseMs = 0.0;
+        if (varied)
+        {
+            PROFILE_ZONE("pose");
+            variedPoses.update(*varied, t, opt.paused, crowd.jobs());
+            poseMs = msSince(t0, clock::now());
+        }
+        const PoseKey key = varied ? variedPoses.key() : crowdPoseKey(rig, opt.count, t, opt.mode, opt.paused);
+        if (key == shown)
+        {
+            if (f >= 0)
+            {
+                if (capture) // la vidéo garde une image par frame
+                    capture->capture(opt.width, opt.height);
+                const double ms = msSince(t0, clock::now());
+                cpuMs.push_back(ms);
+                frameMs.push_back(ms);
+            }
+            continue;
+        }
+        shown = key;
+        if (varied)
+            renderParts(gl, *varied, crowd, variedPoses.parts().data(), variedPoses.parts().size(), opt.instanced, t);
+        else
+            renderScene(gl, rig, crowd, opt.count, opt.instanced, t, opt.mode, opt.paused);
+        if (capture && f >= 0)
+            capture->capture(opt.width, opt.height);
+        glFlush();
+        const auto t1 = clock::now();
+        {
+            PROFILE_ZONE("glFinish");
+            glFinish();
+        }
+        const auto t2 = clock::now();
+
+        if (f >= 0)
+        {
+            ++run.redrawn;
+            cpuMs.push_back(msSince(t0, t1));
+            frameMs.push_back(msSince(t0, t2));
+            run.unsorted += gl.commands.unsortedStats();
+            run.sorted += gl.commands.sortedStats();
+            run.cull += gl.culler.stats();
+            run.animMs += varied ? poseMs : gl.culler.animMs();
+            run.uploadMs += crowd.uploadMs();
+            const LodStats &l = gl.crowdLod.stats();
+            for (int k = 0; k < LodTierCount; ++k)
+                run.lod.characters[k] += l.characters[k];
+            run.lod.posed += l.posed;
+            run.lod.parts += l.parts;
+        }
+    }
+    run.processCpuMs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    run.fps = opt.frames * 1000.0 / msSince(start, clock::now());
+    run.cpu = summarize(cpuMs);
+    run.frame = summarize(frameMs);
+    run.latency = run.frame;
+}
+
+// Instantané transmis du thread de simulation au thread GL
+struct BenchFrame {
+    CrowdPoseCache poses; // reposé seulement si la clé du slot diffère (--paused)
+    float t = 0.0f;
+    int serial = 0;
+    std::chrono::steady_clock::time_point posedAt; // début des poses (latence)
+};
+
+// Deux threads : la simulation pose la frame N+1 pendant que le thread GL
+// (le thread appelant, qui possède le contexte) soumet et termine la frame N.
+// Le producteur attend que l'instantané précédent soit pris avant de poser le
+// suivant : aucune frame n'est sautée, le bench reste déterministe.
+// cpu = soumission GL ; frame = intervalle entre deux frames terminées ;
+// latence = début des poses → fin du glFinish.
+static void loopThreaded(const BenchOptions &opt, SceneGL &gl, const CharacterRenderer &rig, CrowdData *varied,
+                         CrowdRenderer &crowd, JobSystem &jobs, FrameCapture *capture, BenchRun &run)
+{
+    using clock = std::chrono::steady_clock;
+    TripleBuffer<BenchFrame> frames;
+    std::atomic<bool> quit{false};
+
+    std::thread sim([&]
+                    {
+        prof::setThreadName("simulation");
+        for (int f = -opt.warmup; f < opt.frames && !quit; ++f)
+        {
+            // Une frame d'avance au plus : on pose N+1 dès que N est prise
+            while (frames.pending() && !quit)
+                std::this_thread::yield();
+            BenchFrame &back = frames.writeBuffer();
+            back.posedAt = clock::now();
+            back.t = benchTime(opt, f);
+            back.serial = f;
+            PROFILE_ZONE("pose");
+            if (varied)
+                back.poses.update(*varied, back.t, opt.paused, &jobs);
+            else
+                back.poses.update(rig, opt.count, back.t, opt.mode, opt.paused, &jobs);
+            frames.publish();
+        } });
+
+    std::vector<double> cpuMs, frameMs, latencyMs;
+    cpuMs.reserve(opt.frames);
+    frameMs.reserve(opt.frames);
+    latencyMs.reserve(opt.frames);
+    clock::time_point start, prevDone;
+    std::clock_t cpuStart = 0;
+    PoseKey shown;
+    for (int n = -opt.warmup; n < opt.frames; ++n)
+    {
+        while (!frames.acquire())
+            std::this_thread::yield();
+        const BenchFrame &f = frames.readBuffer();
+        prof::gpuFrame();
+        prof::endFrame();
+        if (f.serial == 0)
+        {
+            g_glStats.reset();
+            if (!opt.profile.empty())
+                prof::startCapture();
+            start = prevDone = clock::now();
+            cpuStart = std::clock();
+        }
+
+        const auto t0 = clock::now();
+        if (f.poses.key() == shown) // même image que celle affichée : sautée
+        {
+            if (capture && f.serial >= 0)
+                capture->capture(opt.width, opt.height);
+            const auto t1 = clock::now();
+            if (f.serial >= 0)
+            {
+                cpuMs.push_back(msSince(t0, t1));
+                frameMs.push_back(msSince(prevDone, t1));
+                latencyMs.push_back(msSince(f.posedAt, t1));
+            }
+            prevDone = t1;
+            continue;
+        }
+        shown = f.poses.key();
+        const std::vector<PartInstance> &parts = f.poses.parts();
+        if (varied)
+            renderParts(gl, *varied, crowd, parts.data(), parts.size(), opt.instanced, f.t);
+        else
+            renderParts(gl, rig, crowd, parts.data(), parts.size(), opt.instanced, f.t);
+        if (capture && f.serial >= 0)
+            capture->capture(opt.width, opt.height);
+        glFlush();
+        const auto t1 = clock::now();
+        {
+            PROFILE_ZONE("glFinish");
+            glFinish();
+        }
+        const auto t2 = clock::now();
+
+        if (f.serial >= 0)
+        {
+            ++run.redrawn;
+            cpuMs.push_back(msSince(t0, t1));
+            frameMs.push_back(msSince(prevDone, t2));
+            latencyMs.push_back(msSince(f.posedAt, t2));
+            run.unsorted += gl.commands.unsortedStats();
+            run.sorted += gl.commands.sortedStats();
+            run.cull += gl.culler.stats();
+            run.uploadMs += crowd.uploadMs();
+        }
+        prevDone = t2;
+    }
+    quit = true;
+    sim.join();
+
+    run.processCpuMs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    run.fps = opt.frames * 1000.0 / msSince(start, prevDone);
+    run.cpu = summarize(cpuMs);
+    run.frame = summarize(frameMs);
+    run.latency = summarize(latencyMs);
+}
+
+static bool runGL(const BenchOptions &opt, BenchRun &run)
+{
+    HeadlessGL ctx;
+    if (!createHeadlessGL(opt.width, opt.height, ctx))
+        return false;
+    installGLCallCounters();
+    glstate::invalidate();
+    glEnable(GL_DEPTH_TEST);
+    bool ok = true;
+
+    run.renderer = (const char *)glGetString(GL_RENDERER);
+    run.version = (const char *)glGetString(GL_VERSION);
+    {
+        // Démarrage : compilation des shaders (froid) ou cache binaire (chaud)
+        const auto s0 = std::chrono::steady_clock::now();
+        SceneGL gl = loadSceneGL(opt.shaderCache == "off" ? nullptr : opt.shaderCache.c_str(), opt.proceduralCube);
+        gl.culling = opt.culling;
+        gl.lod = opt.lod;
+        glFinish();
+        run.startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - s0).count();
+        CrowdRenderer crowd(gl.cube);
+        crowd.setTextureBuffer(opt.tbo);
+        JobSystem jobs(opt.threads);
+        crowd.setJobs(&jobs);
+        run.threads = jobs.workerCount();
+        CharacterRenderer rig;
+        AnimLibrary baked;
+        setupRig(opt, rig, baked);
+        CrowdData varied;
+        if (opt.variety)
+            setupVariety(opt, varied);
+        uploadCamera(gl, cameraCount(opt), (float)opt.width / opt.height);
+        std::unique_ptr<FrameCapture> capture;
+        if (opt.capture.enabled())
+        {
+            capture = std::make_unique<FrameCapture>(opt.width, opt.height, opt.capture);
+            if (!capture->ok())
+            {
+                std::cerr << "--capture: " << capture->error() << "\n";
+                ok = false;
+            }
+        }
+
+        CrowdData *crowdData = opt.variety ? &varied : nullptr;
+        if (ok && opt.renderThread)
+            loopThreaded(opt, gl, rig, crowdData, crowd, jobs, capture.get(), run);
+        else if (ok)
+            loopSingle(opt, gl, rig, crowdData, crowd, capture.get(), run);
+        run.calls = g_glStats;
+        if (capture)
+        {
+            capture->finish(); // frames en vol, writer vidé
+            run.capture = capture->stats();
+        }
+        if (!opt.ppm.empty())
+            readPixelsGL(opt, run.lastFrame);
+    } // ressources GL détruites avant le contexte
+
+    prof::gpuShutdown(); // dernières requêtes GPU, lues avant la fin du contexte
+    prof::endFrame();
+    destroyHeadlessGL(ctx);
+    return ok;
+}
+
+// Backend logiciel : pas de contexte GL, poses de la foule puis SoftRasterizer
+static bool runSoft(const BenchOptions &opt, BenchRun &run)
+{
+    if (opt.width > kSoftMaxSize || opt.height > kSoftMaxSize)
+    {
+        std::cerr << "--raster soft: size limited to " << kSoftMaxSize << "x" << kSoftMaxSize << "\n";
+        return false;
+    }
+    JobSystem jobs(opt.threads);
+    run.threads = jobs.workerCount();
+    CharacterRenderer rig;
+    AnimLibrary baked;
+    setupRig(opt, rig, baked);
+    CrowdData varied;
+    if (opt.variety)
+        setupVariety(opt, varied);
+    SoftRasterizer raster;
+    raster.setJobs(&jobs);
+    SoftFramebuffer fb;
+    fb.resize(opt.width, opt.height);
+    const glm::mat4 viewProj = sceneCamera(cameraCount(opt), (float)opt.width / opt.height).viewProj;
+    std::vector<PartInstance> parts((size_t)opt.count * rig.partCount());
+
+    run.renderer = std::string("software rasterizer (") + raster.isa() + ")";
+    run.version = "-";
+
+    // Tout est CPU : cpu = frame = poses + rastérisation
+    std::vector<double> ms;
+    ms.reserve(opt.frames);
+    using clock = std::chrono::steady_clock;
+    clock::time_point start;
+    std::clock_t cpuStart = 0;
+    for (int f = -opt.warmup; f < opt.frames; ++f)
+    {
+        prof::endFrame();
+        if (f == 0)
+        {
+            if (!opt.profile.empty())
+                prof::startCapture();
+            start = clock::now();
+            cpuStart = std::clock();
+        }
+        const auto t0 = clock::now();
+        {
+            PROFILE_ZONE("pose");
+            if (opt.variety)
+                varied.pose(benchTime(opt, f), opt.paused, parts.data(), &jobs);
+            else
+                buildCrowdInstances(rig, opt.count, benchTime(opt, f), opt.mode, opt.paused, parts.data(), &jobs);
+        }
+        {
+            PROFILE_ZONE("raster");
+            raster.render(parts.data(), parts.size(), viewProj, kSceneClearColor, fb);
+        }
+        const auto t1 = clock::now();
+        if (f >= 0)
+            ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    prof::endFrame();
+    run.processCpuMs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    run.redrawn = opt.frames;
+    run.fps = opt.frames * 1000.0 / msSince(start, clock::now());
+    run.cpu = run.frame = run.latency = summarize(ms);
+    if (!opt.ppm.empty())
+        fb.readPixels(run.lastFrame);
+    return true;
+}
+
+// Rendu de la dernière frame du bench par les deux backends, puis part de
+// pixels différents (écart > 2 sur un canal) comparée à opt.validate %.
+static bool validateSoft(const BenchOptions &opt, std::ostream &os)
+{
+    const float t = benchTime(opt, opt.frames - 1);
+    std::vector<uint32_t> ref, soft;
+    {
+        HeadlessGL ctx;
+        if (!createHeadlessGL(opt.width, opt.height, ctx))
+            return false;
+        glstate::invalidate(); // nouveau contexte : le cache décrit l'ancien
+        glEnable(GL_DEPTH_TEST);
+        {
+            SceneGL gl = loadSceneGL(opt.shaderCache == "off" ? nullptr : opt.shaderCache.c_str(), opt.proceduralCube);
+            gl.culling = opt.culling;
+            gl.lod = opt.lod;
+            CrowdRenderer crowd(gl.cube);
+            crowd.setTextureBuffer(opt.tbo);
+            CharacterRenderer rig;
+            AnimLibrary baked;
+            setupRig(opt, rig, baked);
+            uploadCamera(gl, cameraCount(opt), (float)opt.width / opt.height);
+            if (opt.variety)
+            {
+                CrowdData varied;
+                setupVariety(opt, varied);
+                std::vector<PartInstance> parts((size_t)opt.count * varied.partCount());
+                varied.pose(t, opt.paused, parts.data());
+                renderParts(gl, varied, crowd, parts.data(), parts.size(), opt.instanced, t);
+            }
+            else
+                renderScene(gl, rig, crowd, opt.count, opt.instanced, t, opt.mode, opt.paused);
+            readPixelsGL(opt, ref);
+        }
+        prof::gpuShutdown();
+        destroyHeadlessGL(ctx);
+    }
+    {
+        CharacterRenderer rig;
+        AnimLibrary baked;
+        setupRig(opt, rig, baked);
+        std::vector<PartInstance> parts((size_t)opt.count * rig.partCount());
+        if (opt.variety)
+        {
+            CrowdData varied;
+            setupVariety(opt, varied);
+            varied.pose(t, opt.paused, parts.data());
+        }
+        else
+            buildCrowdInstances(rig, opt.count, t, opt.mode, opt.paused, parts.data());
+        SoftRasterizer raster;
+        SoftFramebuffer fb;
+        fb.resize(opt.width, opt.height);
+        raster.render(parts.data(), parts.size(), sceneCamera(cameraCount(opt), (float)opt.width / opt.height).viewProj,
+                      kSceneClearColor, fb);
+        fb.readPixels(soft);
+    }
+
+    size_t diff = 0;
+    for (size_t i = 0; i < ref.size(); ++i)
+    {
+        const unsigned char *a = (const unsigned char *)&ref[i], *b = (const unsigned char *)&soft[i];
+        for (int c = 0; c < 3; ++c)
+            if (std::abs(a[c] - b[c]) > 2)
+            {
+                ++diff;
+                break;
+            }
+    }
+    const double pct = 100.0 * diff / ref.size();
+    const bool ok = pct <= opt.validate;
+    os << "  validate soft vs GL: " << diff << " / " << ref.size() << " pixels differ (" << pct
+              << " %, tolerance " << opt.validate << " %) " << (ok ? "OK" : "FAIL") << "\n";
+    return ok;
+}
+
+int runBench(const BenchOptions &opt)
+{
+    prof::setThreadName("main");
+    if (opt.lod && (opt.softRaster || opt.renderThread || opt.variety))
+        std::cerr << "--lod: ignored with "
+                  << (opt.softRaster ? "--raster soft" : opt.renderThread ? "--render-thread" : "--variety")
+                  << " (single-thread GL loop only, cf. crowd_lod.hpp)\n";
+    BenchRun run;
+    if (!(opt.softRaster ? runSoft(opt, run) : runGL(opt, run)))
+        return 1;
+
+    // --json - : stdout ne reçoit que le JSON, le rapport texte passe sur stderr
+    std::ostream &report = opt.json == "-" ? std::cerr : std::cout;
+    const char *raster = opt.softRaster ? "soft" : "gl";
+    const char *loopName = opt.renderThread && !opt.softRaster ? "threaded" : "single";
+    // LOD et temps d'animation : boucle à un thread, poses faites par
+    // CrowdCuller::build (ou CrowdPoseCache avec --variety)
+    const bool lod = opt.lod && !opt.softRaster && !opt.renderThread && !opt.variety;
+    const bool animTimed = (opt.culling || opt.lod || opt.variety) && !opt.softRaster && !opt.renderThread;
+    report << "HumanGL bench: " << run.renderer << " | " << run.version << "\n"
+              << "  mode=" << modeName(opt.mode) << " count=" << opt.count
+              << " camera=" << cameraCount(opt) << " size=" << opt.width << "x" << opt.height << " raster=" << raster
+              << " path=" << (opt.tbo ? "instanced-tbo" : opt.instanced ? "instanced" : "per-part")
+              << " frames=" << opt.frames << " threads=" << run.threads
+              << " anim=" << (opt.bakedRate <= 0.0f ? "analytic" : opt.compressed ? "compressed" : "baked")
+              << " cube=" << (opt.proceduralCube ? "procedural" : "buffered")
+              << " loop=" << loopName << " cull=" << (opt.culling && !opt.softRaster ? "on" : "off")
+              << " lod=" << (lod ? "on" : "off") << " paused=" << (opt.paused ? "yes" : "no")
+              << " crowd=" << (opt.variety ? "varied" : "uniform") << "\n";
+    if (!opt.softRaster)
+        report << "  startup " << run.startupMs << " ms (shader cache: " << g_programCache.hits << " hit, "
+                  << g_programCache.misses << " miss)\n";
+    printStats(report, "  cpu", run.cpu);
+    printStats(report, "  frame", run.frame);
+    printStats(report, "  latency", run.latency);
+    report << "  throughput " << run.fps << " frames/s\n";
+    // Charge d'un cœur si la même boucle était cadencée à 60 Hz (fenêtre, vsync)
+    const double processCpu = run.processCpuMs / opt.frames;
+    report << "  process cpu/frame " << processCpu << " ms (" << processCpu * 60.0 / 10.0
+              << " % of a core at 60 Hz), redrawn " << run.redrawn << " / " << opt.frames << " frames\n";
+    const GLCallStats &calls = run.calls;
+    if (!opt.softRaster)
+    {
+        report << "  GL calls/frame: " << (double)calls.total() / opt.frames << " (skipped "
+                  << (double)calls.totalSkipped() / opt.frames << ")\n";
+        for (int c = 0; c < CallCount; ++c)
+            if (calls.calls[c] || calls.skipped[c])
+                report << "    " << glCallName(c) << ": " << (double)calls.calls[c] / opt.frames
+                          << " (skipped " << (double)calls.skipped[c] / opt.frames << ")\n";
+    }
+
+    const CullStats &cull = run.cull;
+    if (!opt.softRaster && opt.culling)
+        report << "  culling/frame: characters " << (double)(cull.characters - cull.charactersCulled) / opt.frames
+                  << " / " << (double)cull.characters / opt.frames << " visible, parts "
+                  << (double)(cull.parts - cull.partsCulled) / opt.frames << " / " << (double)cull.parts / opt.frames
+                  << " drawn (" << (double)cull.partsTested / opt.frames << " tested one by one)\n";
+    if (animTimed)
+        report << "  animation/frame: " << run.animMs / opt.frames << " ms\n";
+    if (!opt.softRaster && opt.instanced)
+        report << "  instance upload/frame: " << run.uploadMs / opt.frames << " ms ("
+                  << (opt.tbo ? "texture buffer" : "vertex attributes") << ")\n";
+    if (lod)
+        report << "  lod/frame: full " << (double)run.lod.characters[LodFull] / opt.frames << ", half-rate "
+                  << (double)run.lod.characters[LodHalfRate] / opt.frames << ", merged "
+                  << (double)run.lod.characters[LodMerged] / opt.frames << ", box "
+                  << (double)run.lod.characters[LodBox] / opt.frames << " characters; "
+                  << (double)run.lod.posed / opt.frames << " posed, " << (double)run.lod.parts / opt.frames
+                  << " parts\n";
+    if (opt.capture.enabled())
+        printCaptureStats(report, opt.capture, run.capture, opt.width, opt.height);
+    if (!opt.profile.empty())
+        prof::report(report);
+
+    if (!opt.softRaster && !opt.instanced)
+    {
+        // Ordre d'enregistrement (personnage par personnage) → ordre trié par clé
+        auto changes = [&](const char *name, unsigned long before, unsigned long after)
+        {
+            report << "    " << name << ": " << (double)before / opt.frames << " -> "
+                      << (double)after / opt.frames << "\n";
+        };
+        report << "  state changes/frame (" << (double)run.sorted.commands / opt.frames
+                  << " commands): unsorted " << (double)run.unsorted.changes() / opt.frames << " -> sorted "
+                  << (double)run.sorted.changes() / opt.frames << "\n";
+        changes("program", run.unsorted.programChanges, run.sorted.programChanges);
+        changes("mesh", run.unsorted.meshChanges, run.sorted.meshChanges);
+        changes("material", run.unsorted.materialChanges, run.sorted.materialChanges);
+    }
+
+    int rc = 0;
+    if (!opt.ppm.empty() && !writePPM(opt.ppm.c_str(), opt.width, opt.height, run.lastFrame.data()))
+    {
+        std::cerr << "Cannot write " << opt.ppm << "\n";
+        rc = 1;
+    }
+    if (opt.validate >= 0.0f && !validateSoft(opt, report))
+        rc = 1;
+    if (run.capture.failed)
+    {
+        std::cerr << "--capture: cannot write frames\n";
+        rc = 1;
+    }
+    if (!opt.profile.empty() && !prof::writeChromeTrace(opt.profile.c_str()))
+    {
+        std::cerr << "Cannot write " << opt.profile << "\n";
+        rc = 1;
+    }
+
+    if (!opt.json.empty())
+    {
+        std::ostringstream js;
+        js << "{\n  \"renderer\": " << jsonString(run.renderer) << ",\n  \"version\": " << jsonString(run.version) << ",\n"
+           << "  \"mode\": \"" << modeName(opt.mode) << "\", \"count\": " << opt.count
+           << ", \"camera\": " << cameraCount(opt)
+           << ", \"width\": " << opt.width << ", \"height\": " << opt.height
+           << ", \"raster\": \"" << raster << "\""
+           << ", \"instanced\": " << (opt.instanced ? "true" : "false")
+           << ", \"tbo\": " << (opt.tbo ? "true" : "false")
+           << ", \"frames\": " << opt.frames << ", \"threads\": " << run.threads
+           << ", \"baked_hz\": " << opt.bakedRate
+           << ", \"compressed\": " << (opt.compressed && opt.bakedRate > 0.0f ? "true" : "false")
+           << ", \"cube\": \"" << (opt.proceduralCube ? "procedural" : "buffered") << "\""
+           << ", \"loop\": \"" << loopName << "\""
+           << ", \"cull\": " << (opt.culling && !opt.softRaster ? "true" : "false")
+           << ", \"lod\": " << (lod ? "true" : "false")
+           << ", \"paused\": " << (opt.paused ? "true" : "false")
+           << ", \"variety\": " << (opt.variety ? "true" : "false") << ",\n"
+           << "  \"startup_ms\": " << run.startupMs << ", \"shader_cache\": {\"hits\": " << g_programCache.hits
+           << ", \"misses\": " << g_programCache.misses << "},\n"
+           << "  \"cpu_ms\": ";
+        jsonStats(js, run.cpu);
+        js << ",\n  \"frame_ms\": ";
+        jsonStats(js, run.frame);
+        js << ",\n  \"latency_ms\": ";
+        jsonStats(js, run.latency);
+        js << ",\n  \"throughput_fps\": " << run.fps;
+        js << ",\n  \"process_cpu_ms_per_frame\": " << processCpu << ", \"redrawn_frames\": " << run.redrawn;
+        js << ",\n  \"gl_calls_per_frame\": {";
+        for (int c = 0; c < CallCount; ++c)
+            js << (c ? ", " : "") << "\"" << glCallName(c) << "\": " << (double)calls.calls[c] / opt.frames;
+        js << "},\n  \"gl_skipped_per_frame\": {";
+        for (int c = 0; c < CallCount; ++c)
+            js << (c ? ", " : "") << "\"" << glCallName(c) << "\": " << (double)calls.skipped[c] / opt.frames;
+        js << "},\n  \"state_changes_per_frame\": {";
+        const CommandStats *orders[] = {&run.unsorted, &run.sorted};
+        for (int o = 0; o < 2; ++o)
+        {
+            const CommandStats &c = *orders[o];
+            js << (o ? ", " : "") << "\"" << (o ? "sorted" : "unsorted") << "\": {\"program\": "
+               << (double)c.programChanges / opt.frames << ", \"mesh\": " << (double)c.meshChanges / opt.frames
+               << ", \"material\": " << (double)c.materialChanges / opt.frames << "}";
+        }
+        js << "},\n  \"culling_per_frame\": {\"characters\": " << (double)cull.characters / opt.frames
+           << ", \"characters_culled\": " << (double)cull.charactersCulled / opt.frames
+           << ", \"parts\": " << (double)cull.parts / opt.frames
+           << ", \"parts_culled\": " << (double)cull.partsCulled / opt.frames
+           << ", \"parts_tested\": " << (double)cull.partsTested / opt.frames << "}";
+        if (animTimed)
+            js << ",\n  \"anim_ms_per_frame\": " << run.animMs / opt.frames;
+        if (!opt.softRaster && opt.instanced)
+            js << ",\n  \"upload_ms_per_frame\": " << run.uploadMs / opt.frames;
+        if (opt.capture.enabled())
+        {
+            const CaptureStats &c = run.capture;
+            js << ",\n  \"capture\": {\"depth\": " << opt.capture.depth << ", \"captured\": " << c.captured
+               << ", \"written\": " << c.written << ", \"dropped\": " << c.dropped << ", \"stalls\": " << c.stalls
+               << ", \"read_ms\": " << c.readMs << ", \"wait_ms\": " << c.waitMs << ", \"write_ms\": " << c.writeMs
+               << ", \"fps\": " << (c.wallMs > 0.0 ? c.written * 1000.0 / c.wallMs : 0.0)
+               << ", \"failed\": " << (c.failed ? "true" : "false") << "}";
+        }
+        if (lod)
+            js << ",\n  \"lod_per_frame\": {\"full\": " << (double)run.lod.characters[LodFull] / opt.frames
+               << ", \"half_rate\": " << (double)run.lod.characters[LodHalfRate] / opt.frames
+               << ", \"merged\": " << (double)run.lod.characters[LodMerged] / opt.frames
+               << ", \"box\": " << (double)run.lod.characters[LodBox] / opt.frames
+               << ", \"posed\": " << (double)run.lod.posed / opt.frames
+               << ", \"parts\": " << (double)run.lod.parts / opt.frames << "}";
+        js << "\n}\n";
+
+        if (opt.json == "-")
+            std::cout << js.str();
+        else if (std::ofstream out{opt.json})
+            out << js.str();
+        else
+        {
+            std::cerr << "Cannot write " << opt.json << "\n";
+            rc = 1;
+        }
+    }
+    return rc;
+}
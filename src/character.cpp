@@ -1,209 +1,363 @@
 // character.cpp
 #include "character.hpp"
-#include "gpu.hpp"
-#include "cube.hpp"
+#include "anim_clip.hpp"
+#include "command_buffer.hpp"
+#include "simd_trig.hpp"
+#include <cassert>
 #include <cmath>
 #include <algorithm>
 
-// ---------------------- Helpers: placement only (pas de draw/couleur) ----------------------
+// ---------------------- Courbes d'animation ----------------------
 
-void CharacterRenderer::placeTorso(MatrixStack &ms) const
+AnimChannels evalAnim(AnimMode mode, float tt)
 {
-    // Le cube unité est centré => on scale directement autour du centre du torse
-    ms.scale({P_.torsoW, P_.torsoH, P_.torsoD});
+    AnimChannels ch;
+
+    switch (mode)
+    {
+    case AnimMode::Idle:
+        // tout à 0
+        break;
+
+    case AnimMode::Walk:
+        ch[ChWalk] = std::sin(tt * 2.0f) * 0.6f;
+        ch[ChElbow] = std::sin(tt * 2.0f + 1.57f) * 0.4f;
+        ch[ChHip] = ch[ChWalk];
+        ch[ChKnee] = std::max(0.0f, -std::sin(tt * 2.0f)) * 0.8f;
+        ch[ChBounce] = std::abs(std::sin(tt * 2.0f)) * 0.05f;
+        break;
+
+    case AnimMode::Jump:
+    {
+        const float s = std::sin(tt * 3.0f);
+        ch[ChHip] = std::max(0.0f, -s) * 0.5f;
+        ch[ChKnee] = std::max(0.0f, -s) * 1.2f;   // genoux se plient en flexion
+        ch[ChElbow] = 0.2f * s;                   // bouger un peu les bras
+        ch[ChBounce] = std::max(0.0f, s) * 0.25f; // montée pendant extension
+    }
+    break;
+    }
+
+    // Légère oscillation du torse (tous les modes)
+    ch[ChSway] = 0.2f * std::sin(tt * 0.7f);
+    return ch;
 }
 
-void CharacterRenderer::placeHeadFromTorso(MatrixStack &ms) const
+// Courbes de `mode` pour m ≤ kAnimBatch instants ; set(j, canal, valeur)
+// écrit chaque canal de chaque personnage une fois, dans l'ordre voulu par
+// l'appelant (AoS pour evalAnimBatch, SoA pour les mélanges)
+template <class Set>
+static inline void evalCurves(AnimMode mode, const float *tb, int m, Set &&set)
 {
-    // Depuis le centre du torse → haut du torse + moitié de la tête, puis scale
-    ms.translate({0.0f, P_.torsoH * 0.5f + P_.headH * 0.5f, 0.0f});
-    ms.scale({P_.headH * 0.8f, P_.headH, P_.headH * 0.8f});
+    // Arguments de tous les sinus du bloc rangés à la suite (un tableau par
+    // courbe), un seul appel au noyau vectorisé, puis mêmes combinaisons
+    // qu'evalAnim. La dernière courbe est toujours celle de ChSway.
+    float arg[3 * kAnimBatch], s[3 * kAnimBatch];
+    int curves = 1;
+    switch (mode)
+    {
+    case AnimMode::Idle:
+        break;
+    case AnimMode::Walk:
+        for (int j = 0; j < m; ++j)
+        {
+            arg[j] = tb[j] * 2.0f;
+            arg[m + j] = tb[j] * 2.0f + 1.57f;
+        }
+        curves = 3;
+        break;
+    case AnimMode::Jump:
+        for (int j = 0; j < m; ++j)
+            arg[j] = tb[j] * 3.0f;
+        curves = 2;
+        break;
+    }
+    float *sway = arg + (curves - 1) * m;
+    for (int j = 0; j < m; ++j)
+        sway[j] = tb[j] * 0.7f;
+    sinBatch(arg, s, (size_t)(curves * m));
+
+    // Une boucle par mode (pas de test par personnage), tous les canaux écrits
+    if (mode == AnimMode::Walk)
+        for (int j = 0; j < m; ++j)
+        {
+            const float w = s[j];
+            set(j, ChWalk, w * 0.6f);
+            set(j, ChElbow, s[m + j] * 0.4f);
+            set(j, ChHip, w * 0.6f);
+            set(j, ChKnee, std::max(0.0f, -w) * 0.8f);
+            set(j, ChBounce, std::abs(w) * 0.05f);
+            set(j, ChSway, 0.2f * s[2 * m + j]);
+        }
+    else if (mode == AnimMode::Jump)
+        for (int j = 0; j < m; ++j)
+        {
+            const float v = s[j];
+            set(j, ChWalk, 0.0f);
+            set(j, ChElbow, 0.2f * v);
+            set(j, ChHip, std::max(0.0f, -v) * 0.5f);
+            set(j, ChKnee, std::max(0.0f, -v) * 1.2f);
+            set(j, ChBounce, std::max(0.0f, v) * 0.25f);
+            set(j, ChSway, 0.2f * s[m + j]);
+        }
+    else
+        for (int j = 0; j < m; ++j)
+        {
+            for (int c = 0; c < ChSway; ++c)
+                set(j, c, 0.0f);
+            set(j, ChSway, 0.2f * s[j]);
+        }
 }
 
-void CharacterRenderer::placeUpperArm(MatrixStack &ms) const
+void evalAnimBatch(AnimMode mode, const float *t, int n, AnimChannels *out)
 {
-    // Cube centré → décaler de la moitié de la longueur pour accrocher à l’épaule
-    ms.translate({0.0f, -P_.upperArmL * 0.5f, 0.0f});
-    ms.scale({P_.armR, P_.upperArmL, P_.armR});
+    for (int b = 0; b < n; b += kAnimBatch)
+    {
+        AnimChannels *ob = out + b;
+        evalCurves(mode, t + b, std::min(kAnimBatch, n - b), [ob](int j, int c, float v) { ob[j][c] = v; });
+    }
 }
 
-void CharacterRenderer::placeForearm(MatrixStack &ms, float elbowRot) const
+// ---------------------- Mélange ----------------------
+
+bool operator==(const AnimBlend &a, const AnimBlend &b)
 {
-    // Depuis l’épaule : aller au coude, plier, puis centrer le segment
-    ms.translate({0.0f, -P_.upperArmL, 0.0f});       // coude
-    ms.rotate(elbowRot, {1, 0, 0});                  // flexion du coude
-    ms.translate({0.0f, -P_.foreArmL * 0.5f, 0.0f}); // centrer l’os
-    ms.scale({P_.armR * 0.95f, P_.foreArmL, P_.armR * 0.95f});
+    if (a.count != b.count || a.layers != b.layers)
+        return false;
+    for (int k = 0; k < a.count; ++k)
+        if (a.source[k].clip != b.source[k].clip || a.source[k].speed != b.source[k].speed ||
+            a.weight[k] != b.weight[k])
+            return false;
+    for (int k = 0; k < a.layers; ++k)
+    {
+        const AnimLayer &la = a.layer[k], &lb = b.layer[k];
+        if (la.source.clip != lb.source.clip || la.source.speed != lb.source.speed || la.weight != lb.weight ||
+            la.mask != lb.mask)
+            return false;
+    }
+    return true;
 }
 
-void CharacterRenderer::placeThigh(MatrixStack &ms) const
+// Canaux additifs d'une couche (jamais le rebond, cf. AnimLayer)
+static inline bool layerChannel(const AnimLayer &l, int c)
 {
-    // Depuis la hanche : centrer la cuisse
-    ms.translate({0.0f, -P_.thighL * 0.5f, 0.0f});
-    ms.scale({P_.legR, P_.thighL, P_.legR});
+    return c != ChBounce && (l.mask >> c & 1);
 }
 
-void CharacterRenderer::placeShin(MatrixStack &ms, float kneeRot) const
+AnimChannels evalBlend(const AnimBlend &b, float t)
 {
-    // Depuis la hanche : aller au genou, plier, puis centrer le tibia
-    ms.translate({0.0f, -P_.thighL, 0.0f});       // genou
-    ms.rotate(kneeRot, {1, 0, 0});                // flexion du genou
-    ms.translate({0.0f, -P_.shinL * 0.5f, 0.0f}); // centrer l’os
-    ms.scale({P_.legR * 0.95f, P_.shinL, P_.legR * 0.95f});
+    AnimChannels out;
+    for (int k = 0; k < b.count; ++k)
+    {
+        const AnimChannels ch = evalAnim(b.source[k].clip, t * b.source[k].speed);
+        for (int c = 0; c < ChCount; ++c)
+            out[c] += b.weight[k] * ch[c];
+    }
+    for (int k = 0; k < b.layers; ++k)
+    {
+        const AnimLayer &l = b.layer[k];
+        const AnimChannels ch = evalAnim(l.source.clip, t * l.source.speed);
+        for (int c = 0; c < ChCount; ++c)
+            if (layerChannel(l, c))
+                out[c] += l.weight * ch[c];
+    }
+    return out;
 }
 
-// ---------------------- Rendu bête (1×1×1 à l’origine) : un seul draw par pièce ----------------------
+void evalBlendBatch(const AnimBlend &b, const float *t, int n, AnimChannels *out)
+{
+    float ts[kAnimBatch];
+    ChannelBatch acc;
+    for (int i = 0; i < n; i += kAnimBatch)
+    {
+        const int m = std::min(kAnimBatch, n - i);
+        const float *tb = t + i;
+        AnimChannels *ob = out + i;
+        auto clipTimes = [&](const AnimSource &src)
+        {
+            for (int j = 0; j < m; ++j)
+                ts[j] = tb[j] * src.speed;
+        };
+        if (b.count == 1 && b.layers == 0)
+        {
+            // Une seule source : courbes écrites directement par personnage
+            const float w = b.weight[0];
+            clipTimes(b.source[0]);
+            evalCurves(b.source[0].clip, ts, m, [ob, w](int j, int c, float v) { ob[j][c] = w * v; });
+            continue;
+        }
 
-inline void CharacterRenderer::renderPart(MatrixStack &ms, const glm::vec4 &color) const
+        // acc[canal][personnage] = Σ w_k × source k, accumulé pendant
+        // l'évaluation des courbes : poids communs au bloc, lignes contiguës,
+        // aucune branche par personnage
+        for (int k = 0; k < b.count; ++k)
+        {
+            const float w = b.weight[k];
+            clipTimes(b.source[k]);
+            if (k == 0)
+                evalCurves(b.source[k].clip, ts, m, [&acc, w](int j, int c, float v) { acc.v[c][j] = w * v; });
+            else
+                evalCurves(b.source[k].clip, ts, m, [&acc, w](int j, int c, float v) { acc.v[c][j] += w * v; });
+        }
+        for (int k = 0; k < b.layers; ++k)
+        {
+            // Poids par canal (0 hors du masque) : pas de test dans la boucle
+            const AnimLayer &l = b.layer[k];
+            float w[ChCount];
+            for (int c = 0; c < ChCount; ++c)
+                w[c] = layerChannel(l, c) ? l.weight : 0.0f;
+            clipTimes(l.source);
+            evalCurves(l.source.clip, ts, m, [&acc, &w](int j, int c, float v) { acc.v[c][j] += w[c] * v; });
+        }
+        // SoA → un AnimChannels par personnage (Skeleton::computeWorld)
+        for (int j = 0; j < m; ++j)
+            for (int c = 0; c < ChCount; ++c)
+                ob[j][c] = acc.v[c][j];
+    }
+}
+
+const glm::vec4 &slotColor(const RigColors &c, int slot)
 {
-    setModel(uModel_, ms.top());
-    glUniform4fv(uColor_, 1, &color[0]);
-    draw_unit_cube(cubeVAO_);
+    switch (slot)
+    {
+    case SlotHead:
+        return c.head;
+    case SlotTorso:
+        return c.torso;
+    case SlotArm:
+        return c.arm;
+    default:
+        return c.leg;
+    }
 }
 
-// ---------------------- Assemblage hiérarchique + animation ----------------------
+// ---------------------- Construction ----------------------
 
-void CharacterRenderer::draw(float t, AnimMode mode, bool paused)
+void CharacterRenderer::rebuild()
 {
-    MatrixStack ms;
+    ++revision_;
+    buildHumanoid(P_, S_);
+    bound_ = S_.boundRadius(kMaxAnimTranslation);
+    // Pièce 0 (torse) attachée à la racine : model = world[0] * T(c) * S(s)
+    assert(S_.partJoint[0] == 0);
+    rootInPart0_ = -S_.partCenter[0] / S_.partScale[0];
 
-    const float tt = paused ? 0.0f : t;
+    // LOD : pièces fusionnées → première pièce complète de même couleur
+    buildHumanoidMerged(P_, M_);
+    for (int j = 0; j < M_.partCount(); ++j)
+        mergedIndex_[j] = (uint8_t)(std::find(S_.partColor.begin(), S_.partColor.end(), M_.partColor[j]) -
+                                    S_.partColor.begin());
 
-    float walk = 0.0f;
-    float elbow = 0.0f;
-    float hip = 0.0f;
-    float knee = 0.0f;
-    float bounce = 0.0f;
+    // LOD : boîte englobant les coins de toutes les pièces au repos
+    Affine3x4 world[kMaxJoints], models[kMaxParts];
+    S_.computeWorld(AnimChannels(), Affine3x4(), world);
+    S_.computeParts(world, models);
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    for (int i = 0; i < S_.partCount(); ++i)
+        for (int c = 0; c < 8; ++c)
+        {
+            const glm::vec3 p = transformPoint(models[i], {c & 1 ? 0.5f : -0.5f, c & 2 ? 0.5f : -0.5f,
+                                                           c & 4 ? 0.5f : -0.5f});
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+    boxCenter_ = (lo + hi) * 0.5f;
+    boxSize_ = hi - lo;
+}
 
-    switch (mode)
-    {
-    case AnimMode::Idle:
-        // tout à 0
-        break;
+// ---------------------- Enregistrement : un draw par pièce (cube 1×1×1) ----------------------
 
-    case AnimMode::Walk:
-        walk = std::sin(tt * 2.0f) * 0.6f;
-        elbow = std::sin(tt * 2.0f + 1.57f) * 0.4f;
-        hip = walk;
-        knee = std::max(0.0f, -std::sin(tt * 2.0f)) * 0.8f;
-        bounce = std::abs(std::sin(tt * 2.0f)) * 0.05f;
-        break;
+uint16_t CharacterRenderer::recordMaterials(CommandBuffer &cmds) const
+{
+    const uint16_t base = cmds.addMaterial(slotColor(C_, 0));
+    for (int slot = 1; slot < SlotCount; ++slot)
+        cmds.addMaterial(slotColor(C_, slot));
+    return base;
+}
 
-    case AnimMode::Jump:
+void CharacterRenderer::record(const PartInstance *parts, size_t n, CommandBuffer &cmds, size_t first,
+                               uint16_t materialBase, const uint8_t *partIndex) const
+{
+    DrawCommand *out = cmds.commands() + first;
+    Affine3x4 *transforms = cmds.transforms() + first;
+    const int pc = S_.partCount();
+    for (size_t i = 0; i < n; ++i)
     {
-        const float s = std::sin(tt * 3.0f);
-        hip = std::max(0.0f, -s) * 0.5f;
-        knee = std::max(0.0f, -s) * 1.2f;   // genoux se plient en flexion
-        elbow = 0.2f * s;                   // bouger un peu les bras
-        bounce = std::max(0.0f, s) * 0.25f; // montée pendant extension
-    }
-    break;
+        // Bras/jambes : même matériau → une seule couleur envoyée après tri
+        const int part = partIndex ? partIndex[i] : (int)(i % pc);
+        const uint16_t material = (uint16_t)(materialBase + S_.partColor[part]);
+        transforms[i] = parts[i].model;
+        out[i] = DrawCommand{makeSortKey(ProgramParts, MeshCube, material), (uint32_t)(first + i), material,
+                             ProgramParts, MeshCube};
     }
+}
 
-    // Légère oscillation du torse + rebond vertical
-    ms.translate({0.0f, bounce, 0.0f});
-    ms.rotate(0.2f * std::sin(tt * 0.7f), {0, 1, 0});
+// ---------------------- Squelette + animation ----------------------
 
-    // ---- Racine "torse" : tout le monde en hérite ----
-    ms.push();
-    { // frame du torse (centre)
-        // Torse
-        ms.push();
-        {
-            placeTorso(ms);
-            renderPart(ms, C_.torso);
-        }
-        ms.pop();
+void CharacterRenderer::pose(float t, const AnimBlend &anim, bool paused, const Affine3x4 &root,
+                             PartInstance *out) const
+{
+    const float tt = paused ? 0.0f : t;
+    const AnimChannels ch = baked_ ? AnimChannels() : evalBlend(anim, tt);
+    poseAt(baked_ ? nullptr : &ch, anim, tt, root, C_, out);
+}
 
-        // Tête (enfant direct du torse)
-        ms.push();
-        {
-            placeHeadFromTorso(ms);
-            renderPart(ms, C_.head);
-        }
-        ms.pop();
+void CharacterRenderer::poseBatch(const float *t, int n, const AnimBlend &anim, bool paused, const Affine3x4 *roots,
+                                  PartInstance *out, const RigColors *colors) const
+{
+    const int parts = S_.partCount();
+    const RigColors &palette = colors ? *colors : C_;
+    float tt[kAnimBatch];
+    AnimChannels ch[kAnimBatch];
+    for (int b = 0; b < n; b += kAnimBatch)
+    {
+        const int m = std::min(kAnimBatch, n - b);
+        for (int j = 0; j < m; ++j)
+            tt[j] = paused ? 0.0f : t[b + j];
+        if (!baked_)
+            evalBlendBatch(anim, tt, m, ch);
+        for (int j = 0; j < m; ++j)
+            poseAt(baked_ ? nullptr : &ch[j], anim, tt[j], roots[b + j], palette, out + (size_t)(b + j) * parts);
+    }
+}
 
-        // ---- Bras droit : pivot d’épaule D gardé le temps bras+avant-bras ----
-        ms.push();
-        {
-            ms.translate({+(P_.torsoW * 0.5f + P_.armR), +P_.torsoH * 0.35f, 0.0f}); // pivot épaule D
-            ms.rotate(-walk, {1, 0, 0});                                             // rotation d'épaule (parent)
-            // Haut du bras
-            ms.push();
-            {
-                placeUpperArm(ms);
-                renderPart(ms, C_.arm);
-            }
-            ms.pop();
-            // Avant-bras
-            ms.push();
-            {
-                placeForearm(ms, elbow);
-                renderPart(ms, C_.arm);
-            }
-            ms.pop();
-        }
-        ms.pop();
+void CharacterRenderer::poseAt(const AnimChannels *ch, const AnimBlend &anim, float tt, const Affine3x4 &root,
+                               const RigColors &colors, PartInstance *out) const
+{
+    // Une passe linéaire, pas de pile (cf. Skeleton / buildHumanoid)
+    Affine3x4 world[kMaxJoints];
+    Affine3x4 models[kMaxParts];
+    if (!ch)
+    {
+        // Lookup dans le(s) clip(s) + interpolation au lieu des sin()
+        glm::quat rot[kMaxJoints];
+        glm::vec3 trans[kMaxJoints];
+        sampleBlend(*baked_, S_, anim, tt, rot, trans);
+        S_.computeWorldLocal(rot, trans, root, world);
+    }
+    else
+        S_.computeWorld(*ch, root, world);
+    S_.computeParts(world, models);
 
-        // ---- Bras gauche ----
-        ms.push();
-        {
-            ms.translate({-(P_.torsoW * 0.5f + P_.armR), +P_.torsoH * 0.35f, 0.0f}); // pivot épaule G
-            ms.rotate(+walk, {1, 0, 0});
-            ms.push();
-            {
-                placeUpperArm(ms);
-                renderPart(ms, C_.arm);
-            }
-            ms.pop();
-            ms.push();
-            {
-                placeForearm(ms, -elbow);
-                renderPart(ms, C_.arm);
-            }
-            ms.pop();
-        }
-        ms.pop();
+    const int n = S_.partCount();
+    for (int i = 0; i < n; ++i)
+        out[i] = PartInstance{models[i], slotColor(colors, S_.partColor[i])};
+}
 
-        // ---- Jambe droite : pivot hanche D gardé le temps cuisse+tibia ----
-        ms.push();
-        {
-            ms.translate({+P_.torsoW * 0.25f, -P_.torsoH * 0.5f, 0.0f}); // pivot hanche D
-            ms.rotate(+hip, {1, 0, 0});
-            ms.push();
-            {
-                placeThigh(ms);
-                renderPart(ms, C_.leg);
-            }
-            ms.pop();
-            ms.push();
-            {
-                placeShin(ms, knee);
-                renderPart(ms, C_.leg);
-            }
-            ms.pop();
-        }
-        ms.pop();
+// ---------------------- Niveaux de détail ----------------------
 
-        // ---- Jambe gauche ----
-        ms.push();
-        {
-            ms.translate({-P_.torsoW * 0.25f, -P_.torsoH * 0.5f, 0.0f}); // pivot hanche G
-            ms.rotate(-hip, {1, 0, 0});
-            ms.push();
-            {
-                placeThigh(ms);
-                renderPart(ms, C_.leg);
-            }
-            ms.pop();
-            ms.push();
-            {
-                placeShin(ms, knee);
-                renderPart(ms, C_.leg);
-            }
-            ms.pop();
-        }
-        ms.pop();
-    }
-    ms.pop(); // retour au monde
+void CharacterRenderer::poseMerged(float t, const AnimBlend &anim, bool paused, const Affine3x4 &root,
+                                   PartInstance *out) const
+{
+    Affine3x4 world[kMaxJoints];
+    Affine3x4 models[kMaxParts];
+    M_.computeWorld(evalBlend(anim, paused ? 0.0f : t), root, world);
+    M_.computeParts(world, models);
+    for (int i = 0; i < M_.partCount(); ++i)
+        out[i] = PartInstance{models[i], slotColor(C_, M_.partColor[i])};
+}
+
+PartInstance CharacterRenderer::poseBox(const Affine3x4 &root) const
+{
+    return PartInstance{translateScale(root, boxCenter_, boxSize_), slotColor(C_, S_.partColor[0])};
 }
@@ -0,0 +1,127 @@
+// command_buffer.cpp
+#include "command_buffer.hpp"
+#include "gpu.hpp"
+
+CommandStats &CommandStats::operator+=(const CommandStats &o)
+{
+    commands += o.commands;
+    programChanges += o.programChanges;
+    meshChanges += o.meshChanges;
+    materialChanges += o.materialChanges;
+    return *this;
+}
+
+void CommandBuffer::clear()
+{
+    cmds_.clear();
+    transforms_.clear();
+    materials_.clear();
+    order_.clear();
+    unsorted_ = sorted_ = CommandStats{};
+}
+
+uint16_t CommandBuffer::addMaterial(const glm::vec4 &color)
+{
+    materials_.push_back(color);
+    return (uint16_t)(materials_.size() - 1);
+}
+
+size_t CommandBuffer::allocate(size_t n)
+{
+    const size_t first = cmds_.size();
+    cmds_.resize(first + n);
+    transforms_.resize(first + n);
+    return first;
+}
+
+// Compteurs "null backend" : ce que coûterait l'exécution dans cet ordre
+template <class Index>
+static CommandStats countChanges(const std::vector<DrawCommand> &cmds, Index at)
+{
+    CommandStats s;
+    s.commands = cmds.size();
+    int program = -1, mesh = -1, material = -1;
+    for (size_t i = 0; i < cmds.size(); ++i)
+    {
+        const DrawCommand &c = cmds[at(i)];
+        if (c.program != program)
+        {
+            ++s.programChanges;
+            program = c.program;
+            material = -1; // uniforms propres à chaque programme
+        }
+        if (c.mesh != mesh)
+        {
+            ++s.meshChanges;
+            mesh = c.mesh;
+        }
+        if (c.material != material)
+        {
+            ++s.materialChanges;
+            material = c.material;
+        }
+    }
+    return s;
+}
+
+void CommandBuffer::sort()
+{
+    const size_t n = cmds_.size();
+    unsorted_ = countChanges(cmds_, [](size_t i)
+                             { return i; });
+
+    // Radix LSD sur 8 chiffres de 8 bits ; un seul passage de comptage. Les
+    // chiffres constants (profondeur inutilisée, programme unique…) sont sautés.
+    size_t hist[8][256] = {};
+    for (const DrawCommand &c : cmds_)
+        for (int d = 0; d < 8; ++d)
+            ++hist[d][(c.key >> (8 * d)) & 0xFF];
+
+    order_.resize(n);
+    scratch_.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        order_[i] = (uint32_t)i;
+
+    for (int d = 0; d < 8; ++d)
+    {
+        const size_t first = hist[d][(cmds_.empty() ? 0 : cmds_[0].key >> (8 * d)) & 0xFF];
+        if (first == n)
+            continue;
+        size_t offset[256], sum = 0;
+        for (int b = 0; b < 256; ++b)
+        {
+            offset[b] = sum;
+            sum += hist[d][b];
+        }
+        for (uint32_t idx : order_)
+            scratch_[offset[(cmds_[idx].key >> (8 * d)) & 0xFF]++] = idx;
+        order_.swap(scratch_);
+    }
+
+    sorted_ = countChanges(cmds_, [&](size_t i)
+                           { return order_[i]; });
+}
+
+void executeGL(const CommandBuffer &cmds, const ProgramSlot *programs, const UnitCube *meshes)
+{
+    int program = -1, material = -1;
+    const ProgramSlot *slot = nullptr;
+    for (uint32_t i : cmds.order())
+    {
+        const DrawCommand &c = cmds.command(i);
+        if (c.program != program)
+        {
+            program = c.program;
+            slot = &programs[program];
+            glstate::useProgram(slot->program);
+            material = -1;
+        }
+        if (c.material != material)
+        {
+            material = c.material;
+            glstate::uniform4fv(slot->uColor, cmds.material(c.material));
+        }
+        setModel(slot->uModel, cmds.transform(c.transform));
+        draw_cube(meshes[c.mesh]); // le VAO n'est relié qu'au changement (glstate)
+    }
+}
@@ -0,0 +1,421 @@
+// crowd.cpp
+#include "crowd.hpp"
+#include "command_buffer.hpp"
+#include "crowd_data.hpp"
+#include "crowd_lod.hpp"
+#include "gl_state.hpp"
+#include "gpu.hpp"
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+static const float kCrowdSpacing = 2.0f;
+
+static int crowdSide(int count)
+{
+    return std::max(1, (int)std::ceil(std::sqrt((float)count)));
+}
+
+Affine3x4 crowdRoot(int i, int count)
+{
+    const int side = crowdSide(count);
+    const float half = (side - 1) * 0.5f;
+    const float x = ((i % side) - half) * kCrowdSpacing;
+    const float z = ((i / side) - half) * kCrowdSpacing;
+    return Affine3x4(glm::mat3(1.0f), {x, 0.0f, z});
+}
+
+float crowdExtent(int count)
+{
+    return (crowdSide(count) - 1) * 0.5f * kCrowdSpacing;
+}
+
+void buildCrowdInstances(const CharacterRenderer &rig, int count, float t, const AnimBlend &anim, bool paused,
+                         PartInstance *out, JobSystem *jobs)
+{
+    const int parts = rig.partCount();
+    auto range = [&](int begin, int end)
+    {
+        // Blocs de kAnimBatch personnages : instants et racines en SoA pour poseBatch
+        float times[kAnimBatch];
+        std::fill(times, times + kAnimBatch, t);
+        Affine3x4 roots[kAnimBatch];
+        for (int b = begin; b < end; b += kAnimBatch)
+        {
+            const int m = std::min(kAnimBatch, end - b);
+            for (int j = 0; j < m; ++j)
+                roots[j] = crowdRoot(b + j, count);
+            rig.poseBatch(times, m, anim, paused, roots, out + (size_t)b * parts);
+        }
+    };
+    if (jobs)
+        jobs->parallelFor(count, kCrowdGrain, range);
+    else
+        range(0, count);
+}
+
+void recordCrowd(const CharacterRenderer &rig, int count, float t, const AnimBlend &anim, bool paused,
+                 CommandBuffer &cmds, JobSystem *jobs)
+{
+    const int parts = rig.partCount();
+    const uint16_t materials = rig.recordMaterials(cmds);
+    const size_t first = cmds.allocate((size_t)count * parts);
+    auto range = [&](int begin, int end)
+    {
+        float times[kAnimBatch];
+        std::fill(times, times + kAnimBatch, t);
+        Affine3x4 roots[kAnimBatch];
+        PartInstance posed[kAnimBatch * kMaxParts];
+        for (int b = begin; b < end; b += kAnimBatch)
+        {
+            const int m = std::min(kAnimBatch, end - b);
+            for (int j = 0; j < m; ++j)
+                roots[j] = crowdRoot(b + j, count);
+            rig.poseBatch(times, m, anim, paused, roots, posed);
+            rig.record(posed, (size_t)m * parts, cmds, first + (size_t)b * parts, materials);
+        }
+    };
+    if (jobs)
+        jobs->parallelFor(count, kCrowdGrain, range);
+    else
+        range(0, count);
+}
+
+// ---------------------- Cache de poses ----------------------
+
+PoseKey crowdPoseKey(const CharacterRenderer &rig, int count, float t, const AnimBlend &anim, bool paused)
+{
+    return PoseKey{rig.revision(), count, anim, paused ? 0.0f : t};
+}
+
+PoseKey crowdPoseKey(const CrowdData &crowd, float t, bool paused)
+{
+    PoseKey k;
+    k.rig = crowd.revision();
+    k.count = crowd.size();
+    k.t = paused ? 0.0f : t;
+    k.varied = true;
+    return k;
+}
+
+bool CrowdPoseCache::update(CrowdData &crowd, float t, bool paused, JobSystem *jobs)
+{
+    const PoseKey key = crowdPoseKey(crowd, t, paused);
+    if (key == key_)
+        return false;
+    key_ = key;
+    parts_.resize((size_t)crowd.size() * crowd.partCount());
+    crowd.pose(t, paused, parts_.data(), jobs);
+    return true;
+}
+
+bool CrowdPoseCache::update(const CharacterRenderer &rig, int count, float t, const AnimBlend &anim, bool paused,
+                            JobSystem *jobs)
+{
+    const PoseKey key = crowdPoseKey(rig, count, t, anim, paused);
+    if (key == key_)
+        return false;
+    key_ = key;
+    parts_.resize((size_t)count * rig.partCount());
+    buildCrowdInstances(rig, count, t, anim, paused, parts_.data(), jobs);
+    return true;
+}
+
+// ---------------------- Culling ----------------------
+
+size_t CrowdCuller::build(const CharacterRenderer &rig, int count, float t, const AnimBlend &anim, bool paused,
+                          const Frustum *f, JobSystem *jobs, CrowdLod *lod)
+{
+    // 1. Racines : sphère élargie du rebond maximal, la pose n'est pas encore connue
+    x_.resize(count);
+    y_.resize(count);
+    z_.resize(count);
+    class_.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const glm::vec3 c = crowdRoot(i, count).translation();
+        x_[i] = c.x;
+        y_[i] = c.y;
+        z_[i] = c.z;
+    }
+    if (f)
+        classifySpheres(*f, x_.data(), y_.data(), z_.data(), rig.boundRadius() + kMaxAnimTranslation, count,
+                        class_.data());
+    else
+        std::fill(class_.begin(), class_.end(), (uint8_t)CullInside);
+    chars_.clear();
+    for (int i = 0; i < count; ++i)
+        if (class_[i] != CullOutside)
+            chars_.push_back(i);
+
+    using clock = std::chrono::steady_clock;
+    const auto a0 = clock::now();
+    if (lod)
+    {
+        lod->update(rig, count, chars_, t, anim, paused, jobs);
+        animMs_ = std::chrono::duration<double, std::milli>(clock::now() - a0).count();
+        return collect(rig, count, f, *lod);
+    }
+
+    // Poses des seuls personnages retenus, à la suite (comme buildCrowdInstances)
+    const int parts = rig.partCount();
+    const int kept = (int)chars_.size();
+    posed_.resize((size_t)kept * parts);
+    auto range = [&](int begin, int end)
+    {
+        float times[kAnimBatch];
+        std::fill(times, times + kAnimBatch, t);
+        Affine3x4 roots[kAnimBatch];
+        for (int b = begin; b < end; b += kAnimBatch)
+        {
+            const int m = std::min(kAnimBatch, end - b);
+            for (int j = 0; j < m; ++j)
+                roots[j] = crowdRoot(chars_[b + j], count);
+            rig.poseBatch(times, m, anim, paused, roots, posed_.data() + (size_t)b * parts);
+        }
+    };
+    if (jobs)
+        jobs->parallelFor(kept, kCrowdGrain, range);
+    else
+        range(0, kept);
+    animMs_ = std::chrono::duration<double, std::milli>(clock::now() - a0).count();
+
+    // 2. Sur les poses
+    assert(f);
+    const size_t n = filter(rig, posed_.data(), posed_.size(), *f);
+    stats_.characters += count - kept;
+    stats_.charactersCulled += count - kept;
+    stats_.parts += (size_t)(count - kept) * parts;
+    stats_.partsCulled += (size_t)(count - kept) * parts;
+    return n;
+}
+
+size_t CrowdCuller::collect(const CharacterRenderer &rig, int count, const Frustum *f, const CrowdLod &lod)
+{
+    // Poses du LOD (nombre de pièces variable) : sphère de racine seulement
+    const int kept = (int)chars_.size();
+    stats_ = CullStats{};
+    stats_.characters = count;
+    stats_.charactersCulled = count - kept;
+    stats_.parts = (size_t)(count - kept) * rig.partCount() + lod.stats().parts;
+    visible_.resize(lod.stats().parts);
+    partIndex_.resize(lod.stats().parts);
+    size_t k = 0;
+    for (int i : chars_)
+    {
+        const PartInstance *p = lod.parts(i);
+        const uint8_t *index = lod.partIndex(i);
+        const int n = lod.partCount(i);
+        const bool test = class_[i] == CullIntersect;
+        stats_.partsTested += test ? n : 0;
+        for (int j = 0; j < n; ++j)
+        {
+            if (test && !boxVisible(*f, p[j].model))
+                continue;
+            visible_[k] = p[j];
+            partIndex_[k] = index[j];
+            ++k;
+        }
+    }
+    stats_.partsCulled = stats_.parts - k;
+    parts_ = visible_.data();
+    return k;
+}
+
+size_t CrowdCuller::filter(const CharacterRenderer &rig, const PartInstance *in, size_t n, const Frustum &f)
+{
+    return filterSpheres(rig, rig.boundRadius(), in, n, f);
+}
+
+size_t CrowdCuller::filter(const CrowdData &crowd, const PartInstance *in, size_t n, const Frustum &f)
+{
+    return filterSpheres(crowd.rig(0), crowd.boundRadius(), in, n, f);
+}
+
+// rig : pièces et centre des sphères ; radius : rayon commun
+size_t CrowdCuller::filterSpheres(const CharacterRenderer &rig, float radius, const PartInstance *in, size_t n,
+                                  const Frustum &f)
+{
+    const int parts = rig.partCount();
+    const int count = (int)(n / parts);
+    x_.resize(count);
+    y_.resize(count);
+    z_.resize(count);
+    class_.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const glm::vec3 c = rig.boundCenter(in + (size_t)i * parts);
+        x_[i] = c.x;
+        y_[i] = c.y;
+        z_[i] = c.z;
+    }
+    classifySpheres(f, x_.data(), y_.data(), z_.data(), radius, count, class_.data());
+
+    stats_ = CullStats{};
+    stats_.characters = count;
+    stats_.parts = n;
+    visible_.resize(n);
+    partIndex_.resize(n);
+    character_.resize(n);
+    // Tant que rien n'est retiré, la sortie est l'entrée : pas de copie
+    bool compacted = false;
+    auto drop = [&](size_t k)
+    {
+        if (!compacted)
+            std::copy(in, in + k, visible_.begin());
+        compacted = true;
+    };
+    size_t k = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const PartInstance *p = in + (size_t)i * parts;
+        if (class_[i] == CullOutside)
+        {
+            ++stats_.charactersCulled;
+            drop(k);
+            continue;
+        }
+        const bool test = class_[i] == CullIntersect;
+        stats_.partsTested += test ? parts : 0;
+        for (int j = 0; j < parts; ++j)
+        {
+            if (test && !boxVisible(f, p[j].model))
+            {
+                drop(k);
+                continue;
+            }
+            if (compacted)
+                visible_[k] = p[j];
+            partIndex_[k] = (uint8_t)j;
+            character_[k] = (uint32_t)i;
+            ++k;
+        }
+    }
+    stats_.partsCulled = n - k;
+    parts_ = compacted ? visible_.data() : in;
+    return k;
+}
+
+// ---------------------- Rendu instancié ----------------------
+
+CrowdRenderer::CrowdRenderer(const UnitCube &cube) : cube_(cube)
+{
+    glGenBuffers(1, &instanceVBO_);
+
+    // Les attributs d'instance vivent dans le VAO du cube : simple.vert ne lit
+    // pas les locations 1..4, donc le chemin "une pièce = un draw" n'est pas affecté.
+    glstate::bindVertexArray(cube_.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO_);
+    const GLsizei stride = sizeof(PartInstance);
+    for (int r = 0; r < 3; ++r)
+    {
+        const GLuint loc = 1 + r;
+        glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)(offsetof(PartInstance, model) + r * sizeof(glm::vec4)));
+        glVertexAttribDivisor(loc, 1);
+    }
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void *)offsetof(PartInstance, color));
+    glVertexAttribDivisor(4, 1);
+    glstate::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Texture buffer : le buffer est rattaché une fois, ses réallocations
+    // (glBufferData) n'y changent rien
+    glGenBuffers(1, &instanceTBO_);
+    glGenTextures(1, &instanceTexture_);
+    glBindBuffer(GL_TEXTURE_BUFFER, instanceTBO_);
+    glBindTexture(GL_TEXTURE_BUFFER, instanceTexture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceTBO_);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    tboMaxInstances_ = std::max<size_t>(1, (size_t)maxTexels * sizeof(glm::vec4) / sizeof(PartInstance));
+}
+
+CrowdRenderer::~CrowdRenderer()
+{
+    glDeleteTextures(1, &instanceTexture_);
+    glDeleteBuffers(1, &instanceTBO_);
+    glDeleteBuffers(1, &instanceVBO_);
+}
+
+void CrowdRenderer::setTextureBuffer(bool on)
+{
+    if (on != textureBuffer_)
+        posesUploaded_ = false; // poses_ sont dans l'autre buffer
+    textureBuffer_ = on;
+}
+
+// n pièces dans buffer (capacity en instances), orphaning si elles tiennent
+static void streamInstances(GLenum target, GLuint buffer, size_t &capacity, const PartInstance *parts, size_t n)
+{
+    PROFILE_ZONE("upload");
+    glBindBuffer(target, buffer);
+    const GLsizeiptr bytes = n * sizeof(PartInstance);
+    if (n > capacity)
+    {
+        capacity = n;
+        glBufferData(target, bytes, parts, GL_STREAM_DRAW);
+    }
+    else
+    {
+        // Orphaning : le driver n'attend pas la frame précédente
+        glBufferData(target, capacity * sizeof(PartInstance), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, bytes, parts);
+    }
+    glBindBuffer(target, 0);
+}
+
+void CrowdRenderer::draw(const CharacterRenderer &rig, int count, float t, const AnimBlend &anim, bool paused)
+{
+    const std::vector<PartInstance> &parts = poses_.parts();
+    if (!poses_.update(rig, count, t, anim, paused, jobs_) && posesUploaded_)
+    {
+        uploadMs_ = 0.0;
+        drawUploaded(parts.size());
+        return;
+    }
+    draw(parts.data(), parts.size());
+    // Découpé en tranches, le texture buffer ne garde que la dernière
+    posesUploaded_ = !textureBuffer_ || parts.size() <= tboMaxInstances_;
+}
+
+void CrowdRenderer::draw(const PartInstance *parts, size_t n)
+{
+    using clock = std::chrono::steady_clock;
+    posesUploaded_ = false;
+    if (!textureBuffer_)
+    {
+        const auto t0 = clock::now();
+        streamInstances(GL_ARRAY_BUFFER, instanceVBO_, capacity_, parts, n);
+        uploadMs_ = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+        drawUploaded(n);
+        return;
+    }
+    uploadMs_ = 0.0;
+    for (size_t first = 0; first < n; first += tboMaxInstances_)
+    {
+        const size_t m = std::min(tboMaxInstances_, n - first);
+        const auto t0 = clock::now();
+        streamInstances(GL_TEXTURE_BUFFER, instanceTBO_, tboCapacity_, parts + first, m);
+        uploadMs_ += std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+        drawUploaded(m);
+    }
+}
+
+void CrowdRenderer::drawUploaded(size_t n)
+{
+    if (textureBuffer_)
+    {
+        glActiveTexture(GL_TEXTURE0 + kInstanceTextureUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, instanceTexture_);
+    }
+    draw_cube_instanced(cube_, (GLsizei)n);
+}
@@ -0,0 +1,330 @@
+// crowd_data.cpp
+#include "crowd_data.hpp"
+#include "command_buffer.hpp"
+#include "crowd.hpp"
+#include "jobs.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+// ---------------------- Tables partagées ----------------------
+
+int CrowdData::addBlend(const AnimBlend &b)
+{
+    for (size_t i = 0; i < blends_.size(); ++i)
+        if (blends_[i] == b)
+            return (int)i;
+    assert(blends_.size() < 256);
+    blends_.push_back(b);
+    ++revision_;
+    return (int)blends_.size() - 1;
+}
+
+void CrowdData::setBlend(int i, const AnimBlend &b)
+{
+    if (blends_[i] != b)
+    {
+        blends_[i] = b;
+        ++revision_;
+    }
+}
+
+int CrowdData::addRig(const RigParams &p)
+{
+    for (size_t i = 0; i < rigs_.size(); ++i)
+        if (rigs_[i].params() == p)
+            return (int)i;
+    assert(rigs_.size() < 256);
+    rigs_.emplace_back();
+    rigs_.back().setRig(p);
+    ++revision_;
+    return (int)rigs_.size() - 1;
+}
+
+int CrowdData::addPalette(const RigColors &c)
+{
+    for (size_t i = 0; i < palettes_.size(); ++i)
+        if (palettes_[i] == c)
+            return (int)i;
+    assert(palettes_.size() < 256);
+    palettes_.push_back(c);
+    ++revision_;
+    return (int)palettes_.size() - 1;
+}
+
+float CrowdData::boundRadius() const
+{
+    float r = 0.0f;
+    for (const CharacterRenderer &rig : rigs_)
+        r = std::max(r, rig.boundRadius());
+    return r;
+}
+
+size_t CrowdData::tableBytes() const
+{
+    size_t bytes = blends_.size() * sizeof(AnimBlend) + palettes_.size() * sizeof(RigColors);
+    for (const CharacterRenderer &r : rigs_)
+        bytes += r.memoryBytes();
+    return bytes;
+}
+
+// ---------------------- Personnages ----------------------
+
+int CrowdData::add(const CrowdMember &m)
+{
+    assert(m.blend < blends_.size() && m.rig < rigs_.size() && m.palette < palettes_.size());
+    const uint32_t id = (uint32_t)id_.size();
+    x_.push_back(m.position.x);
+    z_.push_back(m.position.y);
+    phase_.push_back(m.phase);
+    speed_.push_back(m.speed);
+    blend_.push_back(m.blend);
+    rig_.push_back(m.rig);
+    palette_.push_back(m.palette);
+    id_.push_back(id);
+    slot_.push_back(id);
+    sorted_ = false;
+    ++revision_;
+    return (int)id;
+}
+
+CrowdMember CrowdData::member(int id) const
+{
+    const uint32_t i = slot_[id];
+    CrowdMember m;
+    m.position = glm::vec2(x_[i], z_[i]);
+    m.phase = phase_[i];
+    m.speed = speed_[i];
+    m.blend = blend_[i];
+    m.rig = rig_[i];
+    m.palette = palette_[i];
+    return m;
+}
+
+void CrowdData::assignBlend(int id, int blend)
+{
+    assert(blend < (int)blends_.size());
+    uint8_t &b = blend_[slot_[id]];
+    if (b != (uint8_t)blend)
+    {
+        b = (uint8_t)blend;
+        sorted_ = false;
+        ++revision_;
+    }
+}
+
+void CrowdData::clear()
+{
+    for (auto *v : {&x_, &z_, &phase_, &speed_})
+        v->clear();
+    for (auto *v : {&blend_, &rig_, &palette_})
+        v->clear();
+    id_.clear();
+    slot_.clear();
+    runs_.clear();
+    sorted_ = true;
+    blends_.clear();
+    rigs_.clear();
+    palettes_.clear();
+    ++revision_;
+}
+
+void CrowdData::sort()
+{
+    if (sorted_)
+        return;
+    sorted_ = true;
+
+    // Tri par comptage, stable, sur la clé (rig, mélange, palette) : O(n)
+    const int n = size();
+    const int blends = std::max(1, blendCount()), palettes = std::max(1, paletteCount());
+    const int keys = std::max(1, rigCount()) * blends * palettes;
+    auto keyOf = [&](int i) { return (rig_[i] * blends + blend_[i]) * palettes + palette_[i]; };
+    std::vector<int> start(keys + 1, 0);
+    for (int i = 0; i < n; ++i)
+        ++start[keyOf(i) + 1];
+    for (int k = 0; k < keys; ++k)
+        start[k + 1] += start[k];
+
+    std::vector<int> dest(n);
+    {
+        std::vector<int> next(start.begin(), start.end() - 1);
+        for (int i = 0; i < n; ++i)
+            dest[i] = next[keyOf(i)]++;
+    }
+    auto scatter = [&](auto &v)
+    {
+        typename std::remove_reference<decltype(v)>::type out(v.size());
+        for (int i = 0; i < n; ++i)
+            out[dest[i]] = v[i];
+        v.swap(out);
+    };
+    scatter(x_);
+    scatter(z_);
+    scatter(phase_);
+    scatter(speed_);
+    scatter(blend_);
+    scatter(rig_);
+    scatter(palette_);
+    scatter(id_);
+    for (int i = 0; i < n; ++i)
+        slot_[id_[i]] = (uint32_t)i;
+
+    runs_.clear();
+    for (int k = 0; k < keys; ++k)
+        if (start[k + 1] > start[k])
+            runs_.push_back(Run{start[k], start[k + 1], rig_[start[k]], blend_[start[k]], palette_[start[k]]});
+}
+
+// ---------------------- Enregistrement ----------------------
+
+uint16_t CrowdData::recordMaterials(CommandBuffer &cmds) const
+{
+    uint16_t base = 0;
+    for (size_t p = 0; p < palettes_.size(); ++p)
+        for (int slot = 0; slot < SlotCount; ++slot)
+        {
+            const uint16_t m = cmds.addMaterial(slotColor(palettes_[p], slot));
+            if (p == 0 && slot == 0)
+                base = m;
+        }
+    return base;
+}
+
+void CrowdData::record(const PartInstance *parts, size_t n, CommandBuffer &cmds, size_t first,
+                       uint16_t materialBase, const uint8_t *partIndex, const uint32_t *character) const
+{
+    assert(sorted_ && !rigs_.empty());
+    // Mêmes pièces et mêmes emplacements de couleur pour toutes les tailles
+    const Skeleton &s = rigs_[0].skeleton();
+    const int pc = s.partCount();
+    DrawCommand *out = cmds.commands() + first;
+    Affine3x4 *transforms = cmds.transforms() + first;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int part = partIndex ? partIndex[i] : (int)(i % pc);
+        const size_t c = character ? character[i] : i / pc;
+        const uint16_t material = (uint16_t)(materialBase + palette_[c] * SlotCount + s.partColor[part]);
+        transforms[i] = parts[i].model;
+        out[i] = DrawCommand{makeSortKey(ProgramParts, MeshCube, material), (uint32_t)(first + i), material,
+                             ProgramParts, MeshCube};
+    }
+}
+
+// ---------------------- Poses ----------------------
+
+void CrowdData::pose(float t, bool paused, PartInstance *out, JobSystem *jobs)
+{
+    sort();
+    const int parts = partCount();
+    auto range = [&](int begin, int end)
+    {
+        float times[kAnimBatch];
+        Affine3x4 roots[kAnimBatch];
+        // Première plage touchée par [begin, end), puis les suivantes
+        auto run = std::upper_bound(runs_.begin(), runs_.end(), begin,
+                                    [](int i, const Run &r) { return i < r.end; });
+        for (; run != runs_.end() && run->begin < end; ++run)
+        {
+            const CharacterRenderer &rig = rigs_[run->rig];
+            const AnimBlend &blend = blends_[run->blend];
+            const RigColors &palette = palettes_[run->palette];
+            const int last = std::min(end, run->end);
+            for (int b = std::max(begin, run->begin); b < last; b += kAnimBatch)
+            {
+                const int m = std::min(kAnimBatch, last - b);
+                for (int j = 0; j < m; ++j)
+                {
+                    times[j] = t * speed_[b + j] + phase_[b + j];
+                    roots[j] = Affine3x4(glm::mat3(1.0f), {x_[b + j], 0.0f, z_[b + j]});
+                }
+                rig.poseBatch(times, m, blend, paused, roots, out + (size_t)b * parts, &palette);
+            }
+        }
+    };
+    if (jobs)
+        jobs->parallelFor(size(), kCrowdGrain, range);
+    else
+        range(0, size());
+}
+
+// ---------------------- Génération ----------------------
+
+void populateCrowd(CrowdData &crowd, int count, const CrowdVariety &v)
+{
+    crowd.clear();
+    uint32_t state = v.seed;
+    auto rand01 = [&]
+    {
+        state = state * 1664525u + 1013904223u; // LCG (Numerical Recipes)
+        return (state >> 8) * (1.0f / 16777216.0f);
+    };
+
+    // Mélanges : walk en premier (indice 0, cf. CrowdVariety{1, 1, false…}),
+    // puis idle, jump et deux fondus walk → idle figés à mi-chemin
+    std::vector<int> blends{crowd.addBlend(AnimMode::Walk)};
+    if (v.mixedModes)
+    {
+        blends.push_back(crowd.addBlend(AnimMode::Idle));
+        blends.push_back(crowd.addBlend(AnimMode::Jump));
+        for (float w : {0.3f, 0.7f})
+        {
+            AnimBlend fade(AnimMode::Walk);
+            fade.count = 2;
+            fade.source[1].clip = AnimMode::Idle;
+            fade.weight[0] = 1.0f - w;
+            fade.weight[1] = w;
+            blends.push_back(crowd.addBlend(fade));
+        }
+    }
+
+    // Variantes : RigParams par défaut, membres et torse ± 20 % ; teintes décalées
+    std::vector<int> rigs, palettes;
+    for (int r = 0; r < std::max(1, v.rigs); ++r)
+    {
+        RigParams p;
+        if (r > 0)
+        {
+            const float limb = 0.8f + 0.4f * rand01(), body = 0.8f + 0.4f * rand01(), girth = 0.8f + 0.4f * rand01();
+            p.upperArmL *= limb;
+            p.foreArmL *= limb;
+            p.thighL *= limb;
+            p.shinL *= limb;
+            p.torsoH *= body;
+            p.headH *= body;
+            p.torsoW *= girth;
+            p.armR *= girth;
+            p.legR *= girth;
+        }
+        rigs.push_back(crowd.addRig(p));
+    }
+    for (int c = 0; c < std::max(1, v.palettes); ++c)
+    {
+        RigColors col;
+        if (c > 0)
+        {
+            col.torso = glm::vec4(rand01(), rand01(), rand01(), 1.0f);
+            col.leg = glm::vec4(rand01(), rand01(), rand01(), 1.0f);
+            col.arm = glm::mix(col.arm, glm::vec4(rand01(), rand01(), rand01(), 1.0f), 0.5f);
+        }
+        palettes.push_back(crowd.addPalette(col));
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        CrowdMember m;
+        const glm::vec3 root = crowdRoot(i, count).translation();
+        m.position = glm::vec2(root.x, root.z);
+        const float weyl = (float)i * 0.618034f;
+        m.phase = (weyl - std::floor(weyl)) * v.phaseSpan;
+        m.speed = 1.0f + v.speedJitter * (2.0f * rand01() - 1.0f);
+        // Surtout des marcheurs, quelques immobiles, sauteurs et ralentis
+        const float u = rand01();
+        const int pick = !v.mixedModes ? 0 : u < 0.5f ? 0 : u < 0.7f ? 1 : u < 0.85f ? 2 : u < 0.925f ? 3 : 4;
+        m.blend = (uint8_t)blends[pick];
+        m.rig = (uint8_t)rigs[(size_t)(rand01() * rigs.size()) % rigs.size()];
+        m.palette = (uint8_t)palettes[(size_t)(rand01() * palettes.size()) % palettes.size()];
+        crowd.add(m);
+    }
+}
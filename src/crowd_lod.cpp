@@ -0,0 +1,105 @@
+// crowd_lod.cpp
+#include "crowd_lod.hpp"
+#include "crowd.hpp"
+#include "jobs.hpp"
+#include <algorithm>
+
+// Frames entre deux poses de chaque niveau (0 : seulement en y entrant)
+static const uint32_t kLodRate[LodTierCount] = {1, 2, 4, 0};
+
+void CrowdLod::update(const CharacterRenderer &rig, int count, const std::vector<int> &chars, float t,
+                      const AnimBlend &anim, bool paused, JobSystem *jobs)
+{
+    const int pc = rig.partCount();
+    if (count != count_ || pc != stride_ || rig.revision() != revision_)
+    {
+        count_ = count;
+        revision_ = rig.revision();
+        stride_ = pc;
+        cache_.resize((size_t)count * pc);
+        tier_.assign(count, LodFull);
+        live_.assign(count, 0);
+        seen_.assign(count, 0);
+        frame_ = 1; // seen_ = 0 : aucun personnage n'est à jour
+        for (int j = 0; j < pc; ++j)
+            tierIndex_[LodFull][j] = tierIndex_[LodHalfRate][j] = (uint8_t)j;
+        std::copy(rig.mergedPartIndex(), rig.mergedPartIndex() + rig.mergedPartCount(), tierIndex_[LodMerged]);
+        tierIndex_[LodBox][0] = 0;
+    }
+    ++frame_;
+    stats_ = LodStats{};
+    for (std::vector<int> &d : due_)
+        d.clear();
+
+    // Niveaux (hystérésis autour de chaque seuil) et personnages dus
+    const float out = 1.0f + settings.hysteresis, in = 1.0f - settings.hysteresis;
+    for (int i : chars)
+    {
+        const float d = glm::length(crowdRoot(i, count).translation() - eye_);
+        int tier = tier_[i];
+        while (tier < LodBox && d > settings.distance[tier] * out)
+            ++tier;
+        while (tier > LodFull && d < settings.distance[tier - 1] * in)
+            --tier;
+        const bool upToDate = seen_[i] + 1 == frame_ && tier == tier_[i];
+        seen_[i] = frame_;
+        tier_[i] = (uint8_t)tier;
+        ++stats_.characters[tier];
+        const uint32_t rate = kLodRate[tier];
+        if (!upToDate || (rate && (frame_ + i) % rate == 0))
+            due_[tier].push_back(i);
+    }
+
+    // Squelette complet : les deux premiers niveaux ensemble, par blocs de poseBatch
+    std::vector<int> &full = due_[LodFull];
+    full.insert(full.end(), due_[LodHalfRate].begin(), due_[LodHalfRate].end());
+    auto poseFull = [&](int begin, int end)
+    {
+        float times[kAnimBatch];
+        std::fill(times, times + kAnimBatch, t);
+        Affine3x4 roots[kAnimBatch];
+        PartInstance posed[kAnimBatch * kMaxParts];
+        for (int b = begin; b < end; b += kAnimBatch)
+        {
+            const int m = std::min(kAnimBatch, end - b);
+            for (int j = 0; j < m; ++j)
+                roots[j] = crowdRoot(full[b + j], count);
+            rig.poseBatch(times, m, anim, paused, roots, posed);
+            for (int j = 0; j < m; ++j)
+            {
+                const int i = full[b + j];
+                std::copy(posed + j * pc, posed + (j + 1) * pc, &cache_[(size_t)i * pc]);
+                live_[i] = (uint8_t)pc;
+            }
+        }
+    };
+    const std::vector<int> &merged = due_[LodMerged];
+    auto poseMerged = [&](int begin, int end)
+    {
+        for (int k = begin; k < end; ++k)
+        {
+            const int i = merged[k];
+            rig.poseMerged(t, anim, paused, crowdRoot(i, count), &cache_[(size_t)i * pc]);
+            live_[i] = (uint8_t)rig.mergedPartCount();
+        }
+    };
+    if (jobs)
+    {
+        jobs->parallelFor((int)full.size(), kCrowdGrain, poseFull);
+        jobs->parallelFor((int)merged.size(), kCrowdGrain, poseMerged);
+    }
+    else
+    {
+        poseFull(0, (int)full.size());
+        poseMerged(0, (int)merged.size());
+    }
+    for (int i : due_[LodBox])
+    {
+        cache_[(size_t)i * pc] = rig.poseBox(crowdRoot(i, count));
+        live_[i] = 1;
+    }
+
+    stats_.posed = full.size() + merged.size() + due_[LodBox].size();
+    for (int i : chars)
+        stats_.parts += live_[i];
+}
@@ -1,4 +1,6 @@
 #include <glad/glad.h>
+#include "cube.hpp"
+#include "gl_state.hpp"
 
 GLuint make_unit_cube()
 {
@@ -20,7 +22,7 @@ GLuint make_unit_cube()
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
 
-    glBindVertexArray(vao);
+    glstate::bindVertexArray(vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(V), V, GL_STATIC_DRAW);
@@ -31,13 +33,38 @@ GLuint make_unit_cube()
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
 
-    glBindVertexArray(0);
+    glstate::bindVertexArray(0);
     return vao;
 }
 
 void draw_unit_cube(GLuint vao)
 {
-    glBindVertexArray(vao);
+    // Le VAO reste lié : les pièces suivantes n'ont plus rien à rebinder
+    glstate::bindVertexArray(vao);
     glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+}
+
+GLuint make_procedural_cube()
+{
+    // Un VAO reste obligatoire en core profile, même sans attribut
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    return vao;
+}
+
+void draw_cube(const UnitCube &cube)
+{
+    if (!cube.procedural)
+        return draw_unit_cube(cube.vao);
+    glstate::bindVertexArray(cube.vao);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+}
+
+void draw_cube_instanced(const UnitCube &cube, GLsizei instances)
+{
+    glstate::bindVertexArray(cube.vao);
+    if (cube.procedural)
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instances);
+    else
+        glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0, instances);
 }
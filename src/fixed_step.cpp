@@ -0,0 +1,24 @@
+// fixed_step.cpp
+#include "fixed_step.hpp"
+#include <algorithm>
+
+int FixedStep::advance(double elapsed)
+{
+    acc_ += std::max(0.0, elapsed);
+    int steps = (int)(acc_ / dt_);
+    acc_ -= steps * dt_;
+    if (steps > maxSteps_)
+        steps = maxSteps_;
+    time_ += steps * dt_;
+    return steps;
+}
+
+void lerpPoses(const PartInstance *a, const PartInstance *b, size_t n, float alpha, PartInstance *out)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (int r = 0; r < 3; ++r)
+            out[i].model[r] = a[i].model[r] + (b[i].model[r] - a[i].model[r]) * alpha;
+        out[i].color = b[i].color;
+    }
+}
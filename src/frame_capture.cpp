@@ -0,0 +1,332 @@
+// frame_capture.cpp
+#include "frame_capture.hpp"
+#include "helper.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <sys/wait.h>
+
+static double nowMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+enum CaptureFormat { FormatPPM, FormatPNG, FormatRaw };
+
+static bool endsWith(const std::string &s, const char *suffix)
+{
+    const size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static CaptureFormat formatOf(const std::string &pattern)
+{
+    if (endsWith(pattern, ".png"))
+        return FormatPNG;
+    if (endsWith(pattern, ".raw") || endsWith(pattern, ".rgba"))
+        return FormatRaw;
+    return FormatPPM;
+}
+
+// Un seul numéro de frame (%d, largeur éventuelle : %05d) ; tout autre %
+// doit être %% : snprintf lit sinon des arguments qui n'existent pas
+static bool validPattern(const std::string &pattern)
+{
+    int numbers = 0;
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] != '%')
+            continue;
+        if (++i < pattern.size() && pattern[i] == '%')
+            continue;
+        while (i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9')
+            ++i;
+        if (i >= pattern.size() || pattern[i] != 'd')
+            return false;
+        ++numbers;
+    }
+    return numbers == 1;
+}
+
+// ---------------------- Thread de rendu ----------------------
+
+FrameCapture::FrameCapture(int width, int height, const CaptureOptions &opt)
+    : width_(width), height_(height), opt_(opt)
+{
+    opt_.depth = std::max(0, opt_.depth);
+    opt_.queue = std::max(1, opt_.queue);
+    if (!opt_.pipe.empty())
+    {
+        // Encodeur terminé : fwrite échoue au lieu de tuer le processus.
+        // Gestionnaire précédent rendu par le destructeur.
+        sigpipe_ = std::signal(SIGPIPE, SIG_IGN);
+        pipe_ = popen(opt_.pipe.c_str(), "w");
+        if (!pipe_)
+            error_ = "cannot run '" + opt_.pipe + "'";
+    }
+    else if (!validPattern(opt_.pattern))
+        error_ = "capture pattern needs exactly one frame number (%d, %05d...) and no other % than %%";
+    if (!ok())
+        return;
+
+    const size_t bytes = (size_t)width_ * height_ * 4;
+    for (int i = 0; i < opt_.queue; ++i)
+        free_.emplace_back(bytes);
+    slots_.resize(opt_.depth);
+    for (Slot &s : slots_)
+    {
+        glGenBuffers(1, &s.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    writer_ = std::thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    finish();
+    closePipe();
+    if (sigpipe_ != SIG_ERR)
+        std::signal(SIGPIPE, sigpipe_);
+}
+
+// Attend la fin de la commande : un encodeur en échec (statut non nul,
+// signal) rend la capture échouée même si toutes les écritures ont réussi
+void FrameCapture::closePipe()
+{
+    if (!pipe_)
+        return;
+    const int status = pclose(pipe_);
+    pipe_ = nullptr;
+    if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stats_.failed = true;
+        error_ = "'" + opt_.pipe + "' failed (status " + std::to_string(status) + ")";
+    }
+}
+
+bool FrameCapture::acquire(std::vector<uint8_t> &out)
+{
+    std::unique_lock<std::mutex> lk(m_);
+    if (free_.empty())
+    {
+        if (opt_.dropWhenFull)
+        {
+            ++stats_.dropped;
+            return false;
+        }
+        const double t0 = nowMs();
+        cv_.wait(lk, [&] { return !free_.empty(); });
+        stats_.waitMs += nowMs() - t0;
+    }
+    out = std::move(free_.back());
+    free_.pop_back();
+    return true;
+}
+
+void FrameCapture::push(std::vector<uint8_t> &&pixels, int index)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        queue_.push_back(Frame{std::move(pixels), index});
+        ++stats_.captured;
+    }
+    cv_.notify_all();
+}
+
+// PBO écrit il y a depth frames : normalement déjà rempli
+void FrameCapture::retire(Slot &s)
+{
+    if (glClientWaitSync(s.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    {
+        ++stats_.stalls;
+        glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
+    glDeleteSync(s.fence);
+    s.fence = nullptr;
+
+    std::vector<uint8_t> pixels;
+    if (acquire(pixels))
+    {
+        const double t0 = nowMs();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        const void *p = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)pixels.size(), GL_MAP_READ_BIT);
+        if (p)
+        {
+            std::memcpy(pixels.data(), p, pixels.size());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        stats_.readMs += nowMs() - t0;
+        if (p)
+            push(std::move(pixels), s.index);
+        else // map refusé : frame perdue, tampon rendu au pool
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            ++stats_.dropped;
+            free_.push_back(std::move(pixels));
+        }
+    }
+    s.index = -1;
+}
+
+void FrameCapture::capture(int width, int height)
+{
+    if (!ok() || finished_)
+        return;
+    PROFILE_ZONE("capture");
+    if (width != width_ || height != height_)
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        ++stats_.dropped;
+        return;
+    }
+    if (firstCapture_ < 0.0)
+        firstCapture_ = nowMs();
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    // Synchrone : le pipeline se vide ici (référence)
+    if (slots_.empty())
+    {
+        std::vector<uint8_t> pixels;
+        if (!acquire(pixels))
+            return;
+        const double t0 = nowMs();
+        glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        stats_.readMs += nowMs() - t0;
+        push(std::move(pixels), frame_++);
+        return;
+    }
+
+    Slot &s = slots_[next_];
+    if (s.index >= 0)
+        retire(s);
+    const double t0 = nowMs();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); // copie GPU → PBO, sans attendre
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s.index = frame_++;
+    stats_.readMs += nowMs() - t0;
+    next_ = (next_ + 1) % (int)slots_.size();
+}
+
+void FrameCapture::finish()
+{
+    if (finished_)
+        return;
+    finished_ = true;
+    if (!writer_.joinable())
+        return;
+    // Du plus ancien au plus récent
+    for (size_t k = 0; k < slots_.size(); ++k)
+    {
+        Slot &s = slots_[(next_ + k) % slots_.size()];
+        if (s.index >= 0)
+            retire(s);
+    }
+    for (Slot &s : slots_)
+        glDeleteBuffers(1, &s.pbo);
+    slots_.clear();
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        quit_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+    if (pipe_ && std::fflush(pipe_) != 0)
+        stats_.failed = true;
+    closePipe(); // statut de l'encodeur dans stats()
+    if (firstCapture_ >= 0.0)
+        stats_.wallMs = nowMs() - firstCapture_;
+}
+
+CaptureStats FrameCapture::stats() const
+{
+    std::lock_guard<std::mutex> lk(m_);
+    return stats_;
+}
+
+// ---------------------- Writer ----------------------
+
+void FrameCapture::writerLoop()
+{
+    prof::setThreadName("capture writer");
+    for (;;)
+    {
+        Frame f;
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&] { return quit_ || !queue_.empty(); });
+            if (queue_.empty())
+                return; // quit_ et tout est écrit
+            f = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        const double t0 = nowMs();
+        const bool written = write(f);
+        const double ms = nowMs() - t0;
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stats_.writeMs += ms;
+            if (written)
+                ++stats_.written;
+            else
+                stats_.failed = true;
+            free_.push_back(std::move(f.pixels));
+        }
+        cv_.notify_all();
+    }
+}
+
+bool FrameCapture::write(const Frame &f)
+{
+    PROFILE_ZONE("encode");
+    const uint32_t *rgba = (const uint32_t *)f.pixels.data();
+    if (pipe_)
+    {
+        // Lignes de haut en bas, comme les encodeurs les attendent
+        const size_t row = (size_t)width_ * 4;
+        for (int y = height_ - 1; y >= 0; --y)
+            if (std::fwrite(f.pixels.data() + y * row, 1, row, pipe_) != row)
+                return false;
+        return true;
+    }
+
+    char path[1024];
+    std::snprintf(path, sizeof(path), opt_.pattern.c_str(), f.index);
+    switch (formatOf(opt_.pattern))
+    {
+    case FormatPNG:
+        return writePNG(path, width_, height_, rgba);
+    case FormatRaw:
+    {
+        std::ofstream out(path, std::ios::binary);
+        const size_t row = (size_t)width_ * 4;
+        for (int y = height_ - 1; y >= 0 && out; --y)
+            out.write((const char *)f.pixels.data() + y * row, row);
+        return (bool)out;
+    }
+    default:
+        return writePPM(path, width_, height_, rgba);
+    }
+}
+
+void printCaptureStats(std::ostream &os, const CaptureOptions &opt, const CaptureStats &s, int width, int height)
+{
+    const int n = std::max(1, s.captured);
+    char buf[320];
+    std::snprintf(buf, sizeof(buf),
+                  "  capture %dx%d -> %s (%s, depth %d): %d written / %d captured, %d dropped, %d stalls%s\n"
+                  "    render thread %.3f ms/frame (read %.3f, wait %.3f), writer %.2f ms/frame, %.1f frames/s\n",
+                  width, height, opt.pipe.empty() ? opt.pattern.c_str() : opt.pipe.c_str(),
+                  opt.pipe.empty() ? "files" : "pipe", opt.depth, s.written, s.captured, s.dropped, s.stalls,
+                  s.failed ? ", WRITE FAILED" : "", (s.readMs + s.waitMs) / n, s.readMs / n, s.waitMs / n,
+                  s.writeMs / n, s.wallMs > 0.0 ? s.written * 1000.0 / s.wallMs : 0.0);
+    os << buf;
+}
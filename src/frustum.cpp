@@ -0,0 +1,141 @@
+// frustum.cpp
+#include "frustum.hpp"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(FRUSTUM_SCALAR)
+#define FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(FRUSTUM_SCALAR)
+#define FRUSTUM_NEON 1
+#include <arm_neon.h>
+#endif
+
+Frustum extractFrustum(const glm::mat4 &m)
+{
+    // Ligne i de viewProj (glm est en colonnes)
+    auto row = [&](int i)
+    { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+    const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+    const glm::vec4 planes[6] = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+
+    Frustum f;
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec4 p(0.0f, 0.0f, 0.0f, 1.0f);
+        if (i < 6)
+            p = planes[i] / glm::length(glm::vec3(planes[i]));
+        f.nx[i] = p.x;
+        f.ny[i] = p.y;
+        f.nz[i] = p.z;
+        f.d[i] = p.w;
+    }
+    return f;
+}
+
+static uint8_t classifySphere(const Frustum &f, float x, float y, float z, float r)
+{
+    uint8_t res = CullInside;
+    for (int i = 0; i < 6; ++i)
+    {
+        const float dist = f.nx[i] * x + f.ny[i] * y + f.nz[i] * z + f.d[i];
+        if (dist < -r)
+            return CullOutside;
+        if (dist < r)
+            res = CullIntersect;
+    }
+    return res;
+}
+
+// Masques par voie → CullResult (dehors l'emporte sur tout)
+static inline void storeClasses(int outside, int inside, uint8_t *out)
+{
+    for (int j = 0; j < 4; ++j)
+        out[j] = (outside >> j & 1) ? CullOutside : (inside >> j & 1) ? CullInside : CullIntersect;
+}
+
+void classifySpheres(const Frustum &f, const float *x, const float *y, const float *z, float radius, size_t n,
+                     uint8_t *out)
+{
+    size_t i = 0;
+#ifdef FRUSTUM_SSE
+    const __m128 r = _mm_set1_ps(radius), negR = _mm_set1_ps(-radius);
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 X = _mm_loadu_ps(x + i), Y = _mm_loadu_ps(y + i), Z = _mm_loadu_ps(z + i);
+        __m128 outside = _mm_setzero_ps(), inside = _mm_cmpeq_ps(r, r);
+        for (int p = 0; p < 6; ++p)
+        {
+            const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(f.nx[p]), X),
+                                                      _mm_mul_ps(_mm_set1_ps(f.ny[p]), Y)),
+                                           _mm_add_ps(_mm_mul_ps(_mm_set1_ps(f.nz[p]), Z), _mm_set1_ps(f.d[p])));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negR));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, r));
+        }
+        storeClasses(_mm_movemask_ps(outside), _mm_movemask_ps(inside), out + i);
+    }
+#elif defined(FRUSTUM_NEON)
+    const float32x4_t r = vdupq_n_f32(radius), negR = vdupq_n_f32(-radius);
+    for (; i + 4 <= n; i += 4)
+    {
+        const float32x4_t X = vld1q_f32(x + i), Y = vld1q_f32(y + i), Z = vld1q_f32(z + i);
+        uint32x4_t outside = vdupq_n_u32(0), inside = vdupq_n_u32(~0u);
+        for (int p = 0; p < 6; ++p)
+        {
+            const float32x4_t dist = vaddq_f32(vaddq_f32(vmulq_n_f32(X, f.nx[p]), vmulq_n_f32(Y, f.ny[p])),
+                                               vaddq_f32(vmulq_n_f32(Z, f.nz[p]), vdupq_n_f32(f.d[p])));
+            outside = vorrq_u32(outside, vcltq_f32(dist, negR));
+            inside = vandq_u32(inside, vcgeq_f32(dist, r));
+        }
+        // Un bit par voie, comme movemask
+        const uint32x4_t bits = {1, 2, 4, 8};
+        storeClasses((int)vaddvq_u32(vandq_u32(outside, bits)), (int)vaddvq_u32(vandq_u32(inside, bits)), out + i);
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = classifySphere(f, x[i], y[i], z[i], radius);
+}
+
+bool boxVisible(const Frustum &f, const Affine3x4 &m)
+{
+#ifdef FRUSTUM_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f), half = _mm_set1_ps(0.5f);
+    int outside = 0;
+    for (int h = 0; h < 8; h += 4)
+    {
+        const __m128 NX = _mm_load_ps(f.nx + h), NY = _mm_load_ps(f.ny + h), NZ = _mm_load_ps(f.nz + h);
+        // Produit scalaire des 4 normales avec le vecteur (v0, v1, v2)
+        auto dot = [&](float v0, float v1, float v2)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(NX, _mm_set1_ps(v0)), _mm_mul_ps(NY, _mm_set1_ps(v1))),
+                              _mm_mul_ps(NZ, _mm_set1_ps(v2)));
+        };
+        const __m128 dist = _mm_add_ps(dot(m[0].w, m[1].w, m[2].w), _mm_load_ps(f.d + h));
+        // Demi-étendue de la boîte le long de chaque normale : 0.5 × Σ |n · axe|
+        const __m128 e = _mm_mul_ps(half, _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, dot(m[0].x, m[1].x, m[2].x)),
+                                                                 _mm_andnot_ps(signMask, dot(m[0].y, m[1].y, m[2].y))),
+                                                      _mm_andnot_ps(signMask, dot(m[0].z, m[1].z, m[2].z))));
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, e), _mm_setzero_ps()));
+    }
+    return outside == 0;
+#else
+    const glm::vec3 c = m.translation(), a0 = m.column(0), a1 = m.column(1), a2 = m.column(2);
+    for (int i = 0; i < 6; ++i)
+    {
+        const glm::vec3 n(f.nx[i], f.ny[i], f.nz[i]);
+        const float e = 0.5f * (std::fabs(glm::dot(n, a0)) + std::fabs(glm::dot(n, a1)) + std::fabs(glm::dot(n, a2)));
+        if (glm::dot(n, c) + f.d[i] + e < 0.0f)
+            return false;
+    }
+    return true;
+#endif
+}
+
+CullStats &CullStats::operator+=(const CullStats &o)
+{
+    characters += o.characters;
+    charactersCulled += o.charactersCulled;
+    parts += o.parts;
+    partsCulled += o.partsCulled;
+    partsTested += o.partsTested;
+    return *this;
+}
@@ -0,0 +1,13 @@
+// gl_state.cpp
+#include "gl_state.hpp"
+
+namespace glstate {
+
+State g_state;
+
+void invalidate()
+{
+    g_state = State{};
+}
+
+} // namespace glstate
@@ -0,0 +1,89 @@
+// gl_stats.cpp
+#include "gl_stats.hpp"
+
+GLCallStats g_glStats;
+
+unsigned long GLCallStats::total() const
+{
+    unsigned long n = 0;
+    for (unsigned long c : calls)
+        n += c;
+    return n;
+}
+
+unsigned long GLCallStats::totalSkipped() const
+{
+    unsigned long n = 0;
+    for (unsigned long c : skipped)
+        n += c;
+    return n;
+}
+
+const char *glCallName(int call)
+{
+    static const char *const names[CallCount] = {
+        "glDrawElements", "glDrawElementsInstanced", "glDrawArrays", "glDrawArraysInstanced", "glUniformMatrix4fv",
+        "glUniformMatrix3x4fv", "glUniform4fv",
+        "glBindVertexArray", "glUseProgram", "glBufferData", "glBufferSubData"};
+    return (call >= 0 && call < CallCount) ? names[call] : "?";
+}
+
+// ---------------------- Wrappers (compte puis appel réel) ----------------------
+
+// COUNTED(nom glad, type PFN, compteur, (paramètres), (arguments))
+#define COUNTED(fn, pfn, id, params, args)    \
+    static pfn real_##fn = nullptr;           \
+    static void APIENTRY counted_##fn params  \
+    {                                         \
+        ++g_glStats.calls[id];                \
+        real_##fn args;                       \
+    }
+
+COUNTED(glDrawElements, PFNGLDRAWELEMENTSPROC, CallDrawElements,
+        (GLenum m, GLsizei n, GLenum t, const void *i), (m, n, t, i))
+COUNTED(glDrawElementsInstanced, PFNGLDRAWELEMENTSINSTANCEDPROC, CallDrawElementsInstanced,
+        (GLenum m, GLsizei n, GLenum t, const void *i, GLsizei k), (m, n, t, i, k))
+COUNTED(glDrawArrays, PFNGLDRAWARRAYSPROC, CallDrawArrays,
+        (GLenum m, GLint f, GLsizei n), (m, f, n))
+COUNTED(glDrawArraysInstanced, PFNGLDRAWARRAYSINSTANCEDPROC, CallDrawArraysInstanced,
+        (GLenum m, GLint f, GLsizei n, GLsizei k), (m, f, n, k))
+COUNTED(glUniformMatrix4fv, PFNGLUNIFORMMATRIX4FVPROC, CallUniformMatrix4fv,
+        (GLint l, GLsizei n, GLboolean tr, const GLfloat *v), (l, n, tr, v))
+COUNTED(glUniformMatrix3x4fv, PFNGLUNIFORMMATRIX3X4FVPROC, CallUniformMatrix3x4fv,
+        (GLint l, GLsizei n, GLboolean tr, const GLfloat *v), (l, n, tr, v))
+COUNTED(glUniform4fv, PFNGLUNIFORM4FVPROC, CallUniform4fv,
+        (GLint l, GLsizei n, const GLfloat *v), (l, n, v))
+COUNTED(glBindVertexArray, PFNGLBINDVERTEXARRAYPROC, CallBindVertexArray,
+        (GLuint a), (a))
+COUNTED(glUseProgram, PFNGLUSEPROGRAMPROC, CallUseProgram,
+        (GLuint p), (p))
+COUNTED(glBufferData, PFNGLBUFFERDATAPROC, CallBufferData,
+        (GLenum t, GLsizeiptr s, const void *d, GLenum u), (t, s, d, u))
+COUNTED(glBufferSubData, PFNGLBUFFERSUBDATAPROC, CallBufferSubData,
+        (GLenum t, GLintptr o, GLsizeiptr s, const void *d), (t, o, s, d))
+
+#undef COUNTED
+
+#define INSTALL(fn)                \
+    if (!real_##fn)                \
+    {                              \
+        real_##fn = glad_##fn;     \
+        glad_##fn = counted_##fn;  \
+    }
+
+void installGLCallCounters()
+{
+    INSTALL(glDrawElements)
+    INSTALL(glDrawElementsInstanced)
+    INSTALL(glDrawArrays)
+    INSTALL(glDrawArraysInstanced)
+    INSTALL(glUniformMatrix4fv)
+    INSTALL(glUniformMatrix3x4fv)
+    INSTALL(glUniform4fv)
+    INSTALL(glBindVertexArray)
+    INSTALL(glUseProgram)
+    INSTALL(glBufferData)
+    INSTALL(glBufferSubData)
+}
+
+#undef INSTALL
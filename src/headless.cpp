@@ -0,0 +1,143 @@
+// headless.cpp
+#include "headless.hpp"
+#include <iostream>
+
+#ifdef HUMANGL_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static void destroyContext(HeadlessGL &h)
+{
+    eglMakeCurrent((EGLDisplay)h.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext((EGLDisplay)h.display, (EGLContext)h.context);
+    eglTerminate((EGLDisplay)h.display);
+}
+
+static bool createContext(HeadlessGL &h)
+{
+    EGLDisplay dpy = EGL_NO_DISPLAY;
+    auto getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (dpy == EGL_NO_DISPLAY)
+        dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major = 0, minor = 0;
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor))
+    {
+        std::cerr << "EGL init failed\n";
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "EGL: desktop OpenGL unavailable\n";
+        eglTerminate(dpy);
+        return false;
+    }
+
+    // Pas de surface : une config n'est utile que si le driver en exige une
+    const EGLint cfgAttr[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig cfg = nullptr;
+    EGLint n = 0;
+    eglChooseConfig(dpy, cfgAttr, &cfg, 1, &n);
+
+    const EGLint ctxAttr[] = {EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 1,
+                              EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                              EGL_NONE};
+    EGLContext ctx = eglCreateContext(dpy, n > 0 ? cfg : (EGLConfig) nullptr, EGL_NO_CONTEXT, ctxAttr);
+    if (ctx == EGL_NO_CONTEXT || !eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx))
+    {
+        std::cerr << "EGL context failed (0x" << std::hex << eglGetError() << std::dec << ")\n";
+        if (ctx != EGL_NO_CONTEXT)
+            eglDestroyContext(dpy, ctx);
+        eglTerminate(dpy);
+        return false;
+    }
+    h.display = dpy;
+    h.context = ctx;
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        std::cerr << "GLAD load failed\n";
+        destroyContext(h);
+        return false;
+    }
+    return true;
+}
+
+#else
+#include <GLFW/glfw3.h>
+
+static void destroyContext(HeadlessGL &h)
+{
+    glfwDestroyWindow((GLFWwindow *)h.display);
+    glfwTerminate();
+}
+
+static bool createContext(HeadlessGL &h)
+{
+    if (!glfwInit())
+    {
+        std::cerr << "GLFW init failed\n";
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *win = glfwCreateWindow(64, 64, "HumanGL bench", nullptr, nullptr);
+    if (!win)
+    {
+        std::cerr << "Window failed\n";
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(win);
+    h.display = win;
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "GLAD load failed\n";
+        destroyContext(h);
+        return false;
+    }
+    return true;
+}
+#endif
+
+bool createHeadlessGL(int width, int height, HeadlessGL &h)
+{
+    if (!createContext(h))
+        return false;
+
+    h.width = width;
+    h.height = height;
+    glGenRenderbuffers(1, &h.color);
+    glBindRenderbuffer(GL_RENDERBUFFER, h.color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &h.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, h.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &h.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, h.fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, h.color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, h.depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Offscreen framebuffer incomplete\n";
+        destroyHeadlessGL(h); // FBO, renderbuffers, contexte
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void destroyHeadlessGL(HeadlessGL &h)
+{
+    glDeleteFramebuffers(1, &h.fbo);
+    glDeleteRenderbuffers(1, &h.color);
+    glDeleteRenderbuffers(1, &h.depth);
+    destroyContext(h);
+    h = HeadlessGL{};
+}
@@ -1,3 +1,5 @@
+#include "helper.hpp"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -9,3 +11,125 @@ std::string loadFile(const char *path)
     buf << file.rdbuf();
     return buf.str();
 }
+
+bool writePPM(const char *path, int width, int height, const uint32_t *rgba)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+    out << "P6\n" << width << " " << height << "\n255\n";
+    std::string row((size_t)width * 3, '\0');
+    for (int y = height - 1; y >= 0; --y)
+    {
+        const unsigned char *p = (const unsigned char *)(rgba + (size_t)y * width);
+        for (int x = 0; x < width; ++x)
+        {
+            row[x * 3 + 0] = (char)p[x * 4 + 0];
+            row[x * 3 + 1] = (char)p[x * 4 + 1];
+            row[x * 3 + 2] = (char)p[x * 4 + 2];
+        }
+        out.write(row.data(), row.size());
+    }
+    return (bool)out;
+}
+
+// ---------------------- PNG ----------------------
+
+static uint32_t crc32(uint32_t crc, const unsigned char *p, size_t n)
+{
+    static uint32_t table[256];
+    if (!table[1])
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i)
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBE32(std::string &s, uint32_t v)
+{
+    s += (char)(v >> 24);
+    s += (char)(v >> 16);
+    s += (char)(v >> 8);
+    s += (char)v;
+}
+
+static void writeChunk(std::ofstream &out, const char *type, const std::string &data)
+{
+    std::string head;
+    putBE32(head, (uint32_t)data.size());
+    head.append(type, 4);
+    uint32_t crc = crc32(0, (const unsigned char *)type, 4);
+    crc = crc32(crc, (const unsigned char *)data.data(), data.size());
+    std::string tail;
+    putBE32(tail, crc);
+    out << head << data << tail;
+}
+
+bool writePNG(const char *path, int width, int height, const uint32_t *rgba)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+    out.write("\x89PNG\r\n\x1a\n", 8);
+
+    std::string ihdr;
+    putBE32(ihdr, (uint32_t)width);
+    putBE32(ihdr, (uint32_t)height);
+    ihdr += std::string("\x08\x02\x00\x00\x00", 5); // 8 bits, RGB, deflate, filtre 0, pas d'entrelacement
+    writeChunk(out, "IHDR", ihdr);
+
+    // Lignes de haut en bas, octet de filtre 0 puis RGB
+    const size_t rowBytes = (size_t)width * 3 + 1;
+    std::string raw(rowBytes * height, '\0');
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char *p = (const unsigned char *)(rgba + (size_t)(height - 1 - y) * width);
+        char *row = &raw[y * rowBytes + 1];
+        for (int x = 0; x < width; ++x)
+        {
+            row[x * 3 + 0] = (char)p[x * 4 + 0];
+            row[x * 3 + 1] = (char)p[x * 4 + 1];
+            row[x * 3 + 2] = (char)p[x * 4 + 2];
+        }
+    }
+
+    // zlib : en-tête, blocs stockés de 65535 octets au plus, Adler-32
+    std::string z("\x78\x01", 2);
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    size_t pos = 0;
+    do
+    {
+        const size_t len = std::min<size_t>(65535, raw.size() - pos);
+        z += (char)(pos + len == raw.size() ? 1 : 0); // BFINAL, BTYPE 00
+        z += (char)(len & 0xFF);
+        z += (char)(len >> 8);
+        z += (char)(~len & 0xFF);
+        z += (char)((~len >> 8) & 0xFF);
+        z.append(raw, pos, len);
+        pos += len;
+    } while (pos < raw.size());
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size();)
+    {
+        // 5552 octets au plus entre deux modulos (pas de débordement sur 32 bits)
+        const size_t end = std::min(raw.size(), i + 5552);
+        for (; i < end; ++i)
+        {
+            a += (unsigned char)raw[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    putBE32(z, (b << 16) | a);
+    writeChunk(out, "IDAT", z);
+    writeChunk(out, "IEND", std::string());
+    return (bool)out;
+}
@@ -0,0 +1,121 @@
+// jobs.cpp
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+JobSystem::JobSystem(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+    // Le worker 0 est le thread appelant
+    for (unsigned i = 1; i < threads; ++i)
+        threads_.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lk(wakeM_);
+        quit_ = true;
+    }
+    wakeCv_.notify_all();
+    for (std::thread &t : threads_)
+        t.join();
+}
+
+bool JobSystem::pop(unsigned self, Job &out)
+{
+    Queue &q = *queues_[self];
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.jobs.empty())
+        return false;
+    out = q.jobs.back();
+    q.jobs.pop_back();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::steal(unsigned self, Job &out)
+{
+    const unsigned n = workerCount();
+    for (unsigned k = 1; k < n; ++k)
+    {
+        Queue &q = *queues_[(self + k) % n];
+        std::lock_guard<std::mutex> lk(q.m);
+        if (q.jobs.empty())
+            continue;
+        out = q.jobs.front();
+        q.jobs.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::run(const Job &j)
+{
+    {
+        PROFILE_ZONE("job"); // fermée avant que parallelFor ne rende la main
+        (*j.fn)(j.begin, j.end);
+    }
+    pending_.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(unsigned self)
+{
+    char name[16];
+    std::snprintf(name, sizeof(name), "worker %u", self);
+    prof::setThreadName(name);
+    for (;;)
+    {
+        Job j;
+        if (pop(self, j) || steal(self, j))
+        {
+            run(j);
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(wakeM_);
+        wakeCv_.wait(lk, [&]
+                     { return quit_ || queued_.load(std::memory_order_relaxed) > 0; });
+        if (quit_)
+            return;
+    }
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int, int)> &fn)
+{
+    if (count <= 0)
+        return;
+    grain = std::max(1, grain);
+    const int jobCount = (count + grain - 1) / grain;
+    if (jobCount == 1 || workerCount() == 1)
+    {
+        fn(0, count);
+        return;
+    }
+
+    // Répartition round-robin des tranches sur les deques
+    pending_.store(jobCount, std::memory_order_relaxed);
+    const unsigned n = workerCount();
+    for (int j = 0; j < jobCount; ++j)
+    {
+        Queue &q = *queues_[j % n];
+        std::lock_guard<std::mutex> lk(q.m);
+        q.jobs.push_back(Job{&fn, j * grain, std::min(count, (j + 1) * grain)});
+    }
+    {
+        std::lock_guard<std::mutex> lk(wakeM_);
+        queued_.fetch_add(jobCount, std::memory_order_relaxed);
+    }
+    wakeCv_.notify_all();
+
+    // Le thread appelant travaille aussi, puis attend les tranches en vol
+    Job j;
+    while (pop(0, j) || steal(0, j))
+        run(j);
+    while (pending_.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
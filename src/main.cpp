@@ -1,21 +1,198 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include "anim_clip.hpp"
+#include "anim_graph.hpp"
+#include "bench.hpp"
 #include "character.hpp"
-#include "gpu.hpp"
-#include "helper.hpp"
-#include "cube.hpp"
-#include "shader_utils.hpp"
+#include "crowd.hpp"
+#include "crowd_data.hpp"
+#include "fixed_step.hpp"
+#include "frame_capture.hpp"
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include "scene.hpp"
+#include "triple_buffer.hpp"
+
+// Taille du framebuffer, écrite par GLFW sur le thread principal ; le
+// viewport est appliqué par le thread qui possède le contexte (cf. Viewer)
+static int g_fbWidth = 800, g_fbHeight = 600;
 
 static void framebuffer_size_callback(GLFWwindow *, int w, int h)
 {
-    glViewport(0, 0, w, h);
+    g_fbWidth = w;
+    g_fbHeight = h;
+}
+
+// Contenu de la fenêtre perdu (découverte, restauration…) : à redessiner
+// même si rien n'a changé
+static bool g_damaged = false;
+
+static void window_refresh_callback(GLFWwindow *)
+{
+    g_damaged = true;
+}
+
+// Tout ce dont dépend l'image quand l'animation est figée (les shaders ne
+// lisent pas le temps) : même ViewState, même image
+struct ViewState {
+    PoseKey pose;
+    bool instanced = false, tbo = false, culling = true;
+    int width = 0, height = 0;
+
+    bool operator==(const ViewState &o) const
+    {
+        return pose == o.pose && instanced == o.instanced && tbo == o.tbo && culling == o.culling &&
+               width == o.width && height == o.height;
+    }
+};
+
+// Ressources GL de la fenêtre : vivent sur le thread qui possède le contexte
+// (thread principal, ou thread de rendu avec --render-thread)
+struct Viewer {
+    SceneGL gl;
+    CrowdRenderer crowd;
+    CharacterRenderer drawer; // enregistrement seulement : les poses arrivent toutes faites (palette par défaut, comme renderer)
+    int camCount = -1, width = 0, height = 0;
+    CaptureOptions captureOpt;             // --capture : chaque image dessinée
+    std::unique_ptr<FrameCapture> capture; // créée à la première image (taille du framebuffer)
+
+    Viewer(bool proceduralCube, const CaptureOptions &captureOptions)
+        : gl(loadSceneGL(kShaderCacheDir, proceduralCube)), crowd(gl.cube), captureOpt(captureOptions)
+    {
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    ~Viewer()
+    {
+        if (!capture)
+            return;
+        capture->finish();
+        printCaptureStats(std::cout, captureOpt, capture->stats(), capture->width(), capture->height());
+    }
+
+    // varied : foule dont viennent les poses (palettes), nullptr = uniforme
+    void draw(const PartInstance *parts, size_t n, const CrowdData *varied, int count, bool instanced, bool tbo,
+              bool culling, float t, int w, int h)
+    {
+        if (w <= 0 || h <= 0) // fenêtre réduite
+            return;
+        if (w != width || h != height)
+        {
+            glViewport(0, 0, w, h);
+            width = w;
+            height = h;
+            camCount = -1;
+        }
+        if (count != camCount)
+        {
+            uploadCamera(gl, count, (float)w / h);
+            camCount = count;
+        }
+        gl.culling = culling;
+        crowd.setTextureBuffer(tbo);
+        if (varied)
+            renderParts(gl, *varied, crowd, parts, n, instanced, t);
+        else
+            renderParts(gl, drawer, crowd, parts, n, instanced, t);
+
+        if (captureOpt.enabled() && !capture)
+        {
+            capture = std::make_unique<FrameCapture>(w, h, captureOpt);
+            if (!capture->ok())
+            {
+                std::cerr << "--capture: " << capture->error() << "\n";
+                capture.reset();
+                captureOpt = CaptureOptions();
+            }
+        }
+        if (capture)
+            capture->capture(w, h); // back buffer, avant le swap
+    }
+};
+
+// Instantané publié par la simulation pour le thread de rendu (immuable une
+// fois publié : le thread de rendu ne lit que son slot du triple buffer)
+struct RenderFrame {
+    CrowdPoseCache prev, cur;            // deux derniers pas de simulation
+    std::shared_ptr<const CrowdData> varied; // foule variée des poses (palettes), nullptr = uniforme
+    double time = 0.0;                   // temps de simulation de cur
+    double stepWall = 0.0;               // glfwGetTime() où cur est « dû » (alpha = 0)
+    int count = 1;
+    bool instanced = false;
+    bool tbo = false;
+    bool culling = true;
+    int width = 0, height = 0;
+
+    // Deux pas identiques (pause) : plus rien à interpoler
+    bool still() const { return prev.key() == cur.key(); }
+};
+
+// Thread de rendu : possède le contexte, interpole et soumet le dernier
+// instantané à chaque frame (qu'un nouveau pas soit arrivé ou non). Avant le
+// premier instantané, ou sur un instantané figé déjà affiché, il dort un pas.
+static void renderLoop(GLFWwindow *win, bool proceduralCube, const CaptureOptions &capture, double dt,
+                       TripleBuffer<RenderFrame> &frames, const std::atomic<bool> &quit, std::atomic<int> &rendered)
+{
+    glfwMakeContextCurrent(win);
+    prof::setThreadName("render");
+    {
+        Viewer viewer(proceduralCube, capture);
+        std::vector<PartInstance> blended;
+        bool drawnStill = false;
+        while (!quit)
+        {
+            const bool fresh = frames.acquire();
+            const RenderFrame &f = frames.readBuffer();
+            // Rien de publié pour l'instant, ou instantané figé déjà affiché
+            if (f.cur.parts().empty() || (!fresh && drawnStill))
+            {
+                std::this_thread::sleep_for(std::chrono::duration<double>(dt));
+                continue;
+            }
+            const std::vector<PartInstance> &cur = f.cur.parts();
+            const float alpha = (float)std::min(1.0, std::max(0.0, (glfwGetTime() - f.stepWall) / dt));
+            {
+                PROFILE_ZONE("interpolate");
+                blended.resize(cur.size());
+                lerpPoses(f.prev.parts().data(), cur.data(), cur.size(), alpha, blended.data());
+            }
+            viewer.draw(blended.data(), blended.size(), f.varied.get(), f.count, f.instanced, f.tbo, f.culling,
+                        (float)(f.time - dt + alpha * dt), f.width, f.height);
+            {
+                PROFILE_ZONE("swap");
+                glfwSwapBuffers(win);
+            }
+            prof::gpuFrame();
+            drawnStill = f.still();
+            ++rendered;
+        }
+        prof::gpuShutdown();
+    } // ressources GL détruites avec le contexte encore courant
+    glfwMakeContextCurrent(nullptr);
 }
 
-int main()
+int main(int argc, char **argv)
 {
+    // --bench : rendu hors écran, horloge déterministe, stats (cf. bench.hpp)
+    // (--instanced, --tbo, --cube, --render-thread, --no-cull, --paused et --variety valent aussi pour la fenêtre)
+    BenchOptions bench;
+    if (!parseBenchArgs(argc, argv, bench))
+        return 1;
+    if (bench.enabled)
+        return runBench(bench);
+    prof::setThreadName("main");
+    if (bench.lod)
+        std::cerr << "--lod: ignored by the window (fixed-step loop, cf. crowd_lod.hpp)\n";
+    if (!bench.profile.empty())
+        prof::startCapture();
 
     if (!glfwInit())
     {
@@ -41,62 +218,147 @@ int main()
         std::cerr << "GLAD load failed\n";
         return 1;
     }
+    glfwGetFramebufferSize(win, &g_fbWidth, &g_fbHeight);
     glfwSetFramebufferSizeCallback(win, framebuffer_size_callback);
-    glEnable(GL_DEPTH_TEST);
-
-    // Shaders
-    std::string vsSrc = loadFile("shaders/simple.vert");
-    std::string fsSrc = loadFile("shaders/simple.frag");
+    glfwSetWindowRefreshCallback(win, window_refresh_callback);
 
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vsSrc.c_str());
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSrc.c_str());
-    GLuint prog = linkProgram(vs, fs);
-    glUseProgram(prog);
-    GLint uModel = glGetUniformLocation(prog, "model");
+    // --render-thread : le contexte passe au thread de rendu ; ce thread-ci
+    // garde les événements (obligatoire sur macOS), l'input et la simulation.
+    const bool threaded = bench.renderThread;
+    std::unique_ptr<Viewer> viewer;
+    if (!threaded)
+        viewer = std::make_unique<Viewer>(bench.proceduralCube, bench.capture);
+    else
+        glfwMakeContextCurrent(nullptr);
 
-    GLint uView = glGetUniformLocation(prog, "view");
-    GLint uProj = glGetUniformLocation(prog, "projection");
-    GLint uColor = glGetUniformLocation(prog, "uColor");
+    JobSystem jobs; // un worker par cœur pour les poses de la foule
 
-    // Matrices cam/proj
-    glm::mat4 proj = glm::perspective(glm::radians(60.f), 800.f / 600.f, 0.1f, 100.f);
-    glm::mat4 view = glm::lookAt(glm::vec3(2.5f, 2.0f, 4.0f), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
-    glUniformMatrix4fv(uProj, 1, GL_FALSE, &proj[0][0]);
-    glUniformMatrix4fv(uView, 1, GL_FALSE, &view[0][0]);
+    // C : taille de foule 1 → 100 → 1k → 10k ; I : instancié / une pièce = un draw
+    // F : frustum culling on / off ; T : instancié par texture buffer / attributs
+    // V : foule variée (populateCrowd : tailles, palettes, mélanges, phases) / uniforme
+    static const int kCrowdSizes[] = {1, 100, 1000, 10000};
+    int crowdIdx = 0;
+    bool instanced = bench.instanced;
+    bool tbo = bench.tbo;
+    bool culling = bench.culling;
+    bool variety = bench.variety;
 
-    GLuint cubeVAO = make_unit_cube();
+    // Stats de frame (moyenne sur ~1 s, affichée sur stdout)
+    double statStart = glfwGetTime();
+    int statFrames = 0;
 
     RigParams params; // tu peux modifier les tailles à l’oral
     RigColors colors;
-    CharacterRenderer renderer(uModel, uColor, cubeVAO);
+    CharacterRenderer renderer; // poses seulement (pas de GL)
     renderer.setRig(params);
     renderer.setColors(colors);
-    AnimMode mode = AnimMode::Walk;
-    bool paused = false;
+    // 1/2/3 : fondu vers idle / walk / jump ; 4 : "run", état ajouté au graphe.
+    // L : couche additive, balancement des bras de la marche sur l'état courant.
+    AnimGraph graph;
+    const int runState = graph.addState("run", AnimSource{AnimMode::Walk, 1.8f});
+    graph.setFade(-1, (int)AnimMode::Jump, 0.15f); // impulsion : fondu court
+    AnimPlayer player(graph, (int)AnimMode::Walk);
+    bool armLayer = false;
+    bool paused = bench.paused;
 
-    bool prev1 = false, prev2 = false, prev3 = false, prevSpace = false, prevQ = false, prevW = false, prevA = false, prevS = false, prevZ = false, prevX = false;
+    // B : clips cuits à 30 Hz / courbes analytiques. B et Q/W/A/S/Z/X ne
+    // changent que la foule uniforme ; la foule variée a ses propres tailles.
+    AnimLibrary baked;
+    bakeLibrary(renderer.skeleton(), 30.0f, baked);
+    bool useBaked = false;
+
+    // Simulation à 60 Hz, indépendante de la cadence d'affichage : un pas =
+    // poses de toute la foule ; le rendu interpole entre les deux derniers.
+    // Poses en cache (CrowdPoseCache) : en pause, un pas ne recalcule rien.
+    FixedStep sim(1.0 / 60.0);
+    CrowdPoseCache prevPose, curPose;
+    std::vector<PartInstance> blended;
+    // Foule variée : remplacée (jamais modifiée en place) quand la taille
+    // change, le thread de rendu peut encore lire l'ancienne. Ensuite seule
+    // l'entrée 0 des mélanges (les marcheurs, qui suivent le graphe) change,
+    // et le thread de rendu n'en lit que palettes et tailles.
+    std::shared_ptr<CrowdData> varied;
+    auto syncVariety = [&]
+    {
+        const int count = kCrowdSizes[crowdIdx];
+        if (!variety)
+            varied.reset();
+        else if (!varied || varied->size() != count)
+        {
+            auto c = std::make_shared<CrowdData>();
+            populateCrowd(*c, count);
+            c->sort();
+            varied = c;
+        }
+    };
+    auto simulate = [&](CrowdPoseCache &out, double t)
+    {
+        if (varied)
+        {
+            varied->setBlend(0, player.blend((float)t));
+            out.update(*varied, (float)t, paused, &jobs);
+        }
+        else
+            out.update(renderer, kCrowdSizes[crowdIdx], (float)t, player.blend((float)t), paused, &jobs);
+    };
+    syncVariety();
+    simulate(prevPose, 0.0);
+    simulate(curPose, 0.0);
+    bool crowdChanged = false;
+    double lastTime = glfwGetTime();
+    int simSteps = 0;
+
+    TripleBuffer<RenderFrame> frames;
+    std::atomic<bool> quit{false};
+    std::atomic<int> rendered{0};
+    std::thread renderThread;
+    if (threaded)
+        renderThread = std::thread(renderLoop, win, bench.proceduralCube, std::cref(bench.capture), sim.dt(),
+                                   std::ref(frames), std::cref(quit), std::ref(rendered));
+
+    bool prev1 = false, prev2 = false, prev3 = false, prev4 = false, prevL = false, prevSpace = false, prevQ = false, prevW = false, prevA = false, prevS = false, prevZ = false, prevX = false;
+    bool prevC = false, prevI = false, prevB = false, prevF = false, prevT = false, prevV = false;
+
+    // Redessin à la demande : une image figée (pause, rien de modifié) déjà
+    // affichée (ou publiée au thread de rendu) n'est pas refaite, la boucle
+    // dort dans glfwWaitEvents jusqu'au prochain événement
+    ViewState shown;
+    bool shownStill = false;
 
     while (!glfwWindowShouldClose(win))
     {
         // --- Input simple (polling) ---
+        prof::endFrame(); // une itération = une frame (zones de tous les threads)
         bool k1 = glfwGetKey(win, GLFW_KEY_1) == GLFW_PRESS;
         bool k2 = glfwGetKey(win, GLFW_KEY_2) == GLFW_PRESS;
         bool k3 = glfwGetKey(win, GLFW_KEY_3) == GLFW_PRESS;
+        bool k4 = glfwGetKey(win, GLFW_KEY_4) == GLFW_PRESS;
+        bool kL = glfwGetKey(win, GLFW_KEY_L) == GLFW_PRESS;
         bool kSpace = glfwGetKey(win, GLFW_KEY_SPACE) == GLFW_PRESS;
 
-        // toggle mode with edge detection
+        // changement d'état with edge detection : fondu à partir du dernier pas
+        const float simNow = (float)sim.time();
         if (k1 && !prev1)
-            mode = AnimMode::Idle;
+            player.play((int)AnimMode::Idle, simNow);
         if (k2 && !prev2)
-            mode = AnimMode::Walk;
+            player.play((int)AnimMode::Walk, simNow);
         if (k3 && !prev3)
-            mode = AnimMode::Jump;
+            player.play((int)AnimMode::Jump, simNow);
+        if (k4 && !prev4)
+            player.play(runState, simNow);
+        if (kL && !prevL)
+        {
+            armLayer = !armLayer;
+            player.setLayer(0, (int)AnimMode::Walk, armLayer ? 0.6f : 0.0f, 1u << ChElbow);
+        }
         if (kSpace && !prevSpace)
             paused = !paused;
 
         prev1 = k1;
         prev2 = k2;
         prev3 = k3;
+        prev4 = k4;
+        prevL = kL;
         prevSpace = kSpace;
 
         // --- Ajuster les dimensions à la volée ---
@@ -151,19 +413,187 @@ int main()
         prevZ = kZ;
         prevX = kX;
 
-        glClearColor(0.08f, 0.09f, 0.11f, 1.f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        bool kC = glfwGetKey(win, GLFW_KEY_C) == GLFW_PRESS;
+        bool kI = glfwGetKey(win, GLFW_KEY_I) == GLFW_PRESS;
+        if (kC && !prevC)
+            crowdIdx = (crowdIdx + 1) % 4; // caméra mise à jour par Viewer
+        if (kI && !prevI)
+            instanced = !instanced;
+        bool kB = glfwGetKey(win, GLFW_KEY_B) == GLFW_PRESS;
+        if (kB && !prevB)
+        {
+            useBaked = !useBaked;
+            renderer.setBaked(useBaked ? &baked : nullptr);
+        }
+        bool kF = glfwGetKey(win, GLFW_KEY_F) == GLFW_PRESS;
+        if (kF && !prevF)
+            culling = !culling;
+        bool kT = glfwGetKey(win, GLFW_KEY_T) == GLFW_PRESS;
+        if (kT && !prevT)
+            tbo = !tbo;
+        bool kV = glfwGetKey(win, GLFW_KEY_V) == GLFW_PRESS;
+        if (kV && !prevV)
+            variety = !variety;
+        prevC = kC;
+        prevI = kI;
+        prevB = kB;
+        prevF = kF;
+        prevT = kT;
+        prevV = kV;
+        const int crowdCount = kCrowdSizes[crowdIdx];
+        // Autre foule (V, ou C en foule variée) : rien à interpoler avec
+        // l'ancienne, jusqu'au prochain pas simulé
+        const CrowdData *lastCrowd = varied.get();
+        syncVariety();
+        crowdChanged = crowdChanged || varied.get() != lastCrowd;
+        {
+            PROFILE_ZONE("setRig");
+            renderer.setRig(params); // si tu as modifié params via Q/W/A/S/Z/X (sans effet sinon)
+        }
+
+        // --- Simulation : pas fixes dus depuis la dernière frame ---
+        // Les poses ne dépendent que du temps : si plusieurs pas sont dus
+        // (frame lente), seuls les deux derniers sont évalués.
+        const double now = glfwGetTime();
+        const int steps = sim.advance(now - lastTime);
+        lastTime = now;
 
-        float t = (float)glfwGetTime();
+        // Image voulue au temps du dernier pas ; à jour si une image figée
+        // (deux pas de même pose) de ce ViewState est déjà affichée / publiée
+        const float stepTime = (float)sim.time();
+        if (varied)
+            varied->setBlend(0, player.blend(stepTime));
+        const PoseKey stepKey = varied ? crowdPoseKey(*varied, stepTime, paused)
+                                       : crowdPoseKey(renderer, crowdCount, stepTime, player.blend(stepTime), paused);
+        const ViewState view{stepKey, instanced, tbo, culling, g_fbWidth, g_fbHeight};
+        const bool upToDate = shownStill && view == shown && !g_damaged;
 
-        // dessiner le personnage articulé
-        renderer.setRig(params); // si tu as modifié params via Q/W/A/S/Z/X
-        renderer.draw(t, mode, paused);
+        if (steps > 0 && !threaded)
+        {
+            PROFILE_ZONE("simulate");
+            if (steps >= 2)
+                simulate(prevPose, sim.time() - sim.dt());
+            else
+                std::swap(prevPose, curPose);
+            simulate(curPose, sim.time());
+            if (crowdChanged || prevPose.parts().size() != curPose.parts().size()) // autre foule
+                prevPose = curPose;
+            crowdChanged = false;
+        }
+        else if (steps > 0 && !upToDate)
+        {
+            // Pose directement dans le slot libre ; curPose garde le dernier
+            // pas publié (seule copie), le slot part tel quel au rendu.
+            PROFILE_ZONE("simulate");
+            RenderFrame &back = frames.writeBuffer();
+            if (steps >= 2)
+                simulate(curPose, sim.time() - sim.dt());
+            std::swap(back.prev, curPose);
+            simulate(back.cur, sim.time());
+            if (crowdChanged || back.prev.parts().size() != back.cur.parts().size())
+                back.prev = back.cur;
+            crowdChanged = false;
+            back.varied = varied;
+            curPose = back.cur;
+            back.time = sim.time();
+            back.stepWall = now - sim.alpha() * sim.dt();
+            back.count = crowdCount;
+            back.instanced = instanced;
+            back.tbo = tbo;
+            back.culling = culling;
+            back.width = g_fbWidth;
+            back.height = g_fbHeight;
+            frames.publish();
+            shown = view;
+            shownStill = back.still();
+            g_damaged = false;
+        }
+        simSteps += steps;
 
-        glfwSwapBuffers(win);
-        glfwPollEvents();
+        if (!threaded)
+        {
+            const bool still = prevPose.key() == view.pose && curPose.key() == view.pose;
+            if (still && upToDate)
+            {
+                PROFILE_ZONE("wait events");
+                glfwWaitEvents(); // pause, rien de modifié : plus aucun travail jusqu'au prochain événement
+            }
+            else
+            {
+                // --- Rendu : pose interpolée entre les deux derniers pas (inutile si figée) ---
+                const std::vector<PartInstance> &cur = curPose.parts();
+                if (!still)
+                {
+                    PROFILE_ZONE("interpolate");
+                    blended.resize(cur.size());
+                    lerpPoses(prevPose.parts().data(), cur.data(), cur.size(), sim.alpha(), blended.data());
+                }
+                viewer->draw(still ? cur.data() : blended.data(), cur.size(), varied.get(), crowdCount, instanced, tbo,
+                             culling, (float)sim.renderTime(), g_fbWidth, g_fbHeight);
+                {
+                    PROFILE_ZONE("swap");
+                    glfwSwapBuffers(win);
+                }
+                prof::gpuFrame();
+                {
+                    PROFILE_ZONE("poll events");
+                    glfwPollEvents();
+                }
+                shown = view;
+                shownStill = still;
+                g_damaged = false;
+                ++statFrames;
+            }
+        }
+        else
+        {
+            // Rien à faire jusqu'au prochain pas : on dort dans l'attente
+            // d'événements, sans limite si l'image publiée est figée
+            PROFILE_ZONE("wait events");
+            if (upToDate)
+                glfwWaitEvents();
+            else
+                glfwWaitEventsTimeout(std::max(0.0, (1.0 - sim.alpha()) * sim.dt()));
+            statFrames = rendered.exchange(0) + statFrames;
+        }
+
+        if (now - statStart >= 1.0)
+        {
+            std::cout << "crowd=" << crowdCount
+                      << " path=" << (!instanced ? "per-part" : tbo ? "instanced-tbo" : "instanced");
+            if (statFrames > 0)
+                std::cout << " frame=" << (now - statStart) * 1000.0 / statFrames << " ms";
+            else
+                std::cout << " frame=idle";
+            std::cout << " sim=" << simSteps / (now - statStart) << " Hz"
+                      << " loop=" << (threaded ? "threaded" : "single") << " cull=" << (culling ? "on" : "off")
+                      << " crowd=" << (varied ? "varied" : "uniform");
+            if (culling && !threaded) // le culler vit sur le thread de rendu sinon
+            {
+                const CullStats &c = viewer->gl.culler.stats();
+                std::cout << " visible=" << c.characters - c.charactersCulled << "/" << c.characters
+                          << " parts=" << c.parts - c.partsCulled << "/" << c.parts;
+            }
+            std::cout << "\n";
+            prof::report(std::cout);
+            statStart = now;
+            statFrames = 0;
+            simSteps = 0;
+        }
     }
 
+    quit = true;
+    if (renderThread.joinable())
+        renderThread.join();
+    if (!threaded)
+        prof::gpuShutdown();
+    viewer.reset(); // avant la destruction du contexte
     glfwTerminate();
+    prof::endFrame();
+    if (!bench.profile.empty() && !prof::writeChromeTrace(bench.profile.c_str()))
+    {
+        std::cerr << "Cannot write " << bench.profile << "\n";
+        return 1;
+    }
     return 0;
 }
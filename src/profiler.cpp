@@ -0,0 +1,311 @@
+// profiler.cpp
+#include "profiler.hpp"
+
+#ifdef HUMANGL_PROFILE
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace prof {
+
+// ---------------------- Anneaux par thread ----------------------
+
+struct Event {
+    const char* name;
+    uint64_t begin, end;
+    bool gpu;
+};
+
+// Un producteur (le thread propriétaire), un consommateur (endFrame) :
+// head n'est écrit que par le premier, tail que par le second
+static const uint32_t kRingSize = 1u << 14; // puissance de 2
+
+struct ThreadLog {
+    Event ring[kRingSize];
+    std::atomic<uint32_t> head{0}, tail{0};
+    std::atomic<uint32_t> dropped{0}; // anneau plein : zones perdues
+    int tid = 0;
+    char name[32] = {};
+};
+
+// Journaux jamais libérés : un thread terminé garde sa place dans la trace
+static std::mutex g_logsM;
+static std::vector<std::unique_ptr<ThreadLog>> g_logs;
+
+static ThreadLog& localLog()
+{
+    thread_local ThreadLog* log = nullptr;
+    if (!log)
+    {
+        std::lock_guard<std::mutex> lk(g_logsM);
+        g_logs.push_back(std::make_unique<ThreadLog>());
+        log = g_logs.back().get();
+        log->tid = (int)g_logs.size();
+        std::snprintf(log->name, sizeof(log->name), "thread %d", log->tid);
+    }
+    return *log;
+}
+
+void record(const char* name, uint64_t begin, uint64_t end, bool gpu)
+{
+    ThreadLog& log = localLog();
+    const uint32_t h = log.head.load(std::memory_order_relaxed);
+    if (h - log.tail.load(std::memory_order_acquire) >= kRingSize)
+    {
+        log.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    log.ring[h & (kRingSize - 1)] = Event{name, begin, end, gpu};
+    log.head.store(h + 1, std::memory_order_release);
+}
+
+void setThreadName(const char* name)
+{
+    ThreadLog& log = localLog();
+    std::lock_guard<std::mutex> lk(g_logsM); // lu par writeChromeTrace
+    std::snprintf(log.name, sizeof(log.name), "%s", name);
+}
+
+// ---------------------- Requêtes GPU ----------------------
+
+// Thread GL seulement. Anneau de kGpuLatency + 1 frames : la frame qu'on
+// réutilise est celle d'il y a kGpuLatency frames, lue juste avant.
+static const int kGpuFrames = kGpuLatency + 1;
+static const int kGpuZonesPerFrame = 16;
+
+struct GpuFrame {
+    GLuint query[kGpuZonesPerFrame] = {};
+    const char* name[kGpuZonesPerFrame] = {};
+    uint64_t begin[kGpuZonesPerFrame] = {};
+    int count = 0;
+};
+
+static GpuFrame g_gpu[kGpuFrames];
+static bool g_gpuReady = false;
+static int g_gpuFrame = 0;
+static int g_gpuDepth = 0;
+static bool g_gpuActive = false;
+static std::atomic<uint32_t> g_gpuDropped{0}; // requêtes pas prêtes à temps, invalides, ou frame pleine
+
+void gpuBegin(const char* name)
+{
+    if (g_gpuDepth++ > 0)
+        return; // imbriquée : seule la zone extérieure est mesurée
+    if (!g_gpuReady)
+    {
+        for (GpuFrame& f : g_gpu)
+            glGenQueries(kGpuZonesPerFrame, f.query);
+        g_gpuReady = true;
+    }
+    GpuFrame& f = g_gpu[g_gpuFrame];
+    g_gpuActive = f.count < kGpuZonesPerFrame;
+    if (!g_gpuActive)
+    {
+        g_gpuDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    f.name[f.count] = name;
+    f.begin[f.count] = now();
+    glBeginQuery(GL_TIME_ELAPSED, f.query[f.count++]);
+}
+
+void gpuEnd()
+{
+    if (--g_gpuDepth > 0)
+        return;
+    if (g_gpuActive)
+        glEndQuery(GL_TIME_ELAPSED);
+    g_gpuActive = false;
+}
+
+// wait : lecture bloquante (fin de contexte) ; sinon ce qui n'est pas prêt est perdu
+static void readGpuFrame(GpuFrame& f, bool wait)
+{
+    for (int i = 0; i < f.count; ++i)
+    {
+        GLint ready = 1;
+        if (!wait)
+            glGetQueryObjectiv(f.query[i], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready)
+        {
+            g_gpuDropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(f.query[i], GL_QUERY_RESULT, &ns);
+        // Plus long que le temps écoulé depuis la soumission : résultat faux
+        // (llvmpipe renvoie une date absolue pour la toute première requête)
+        if (ns > now() - f.begin[i])
+        {
+            g_gpuDropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        record(f.name[i], f.begin[i], f.begin[i] + ns, true);
+    }
+    f.count = 0;
+}
+
+void gpuFrame()
+{
+    if (!g_gpuReady)
+        return;
+    g_gpuFrame = (g_gpuFrame + 1) % kGpuFrames;
+    readGpuFrame(g_gpu[g_gpuFrame], false);
+}
+
+void gpuShutdown()
+{
+    if (!g_gpuReady)
+        return;
+    // De la plus ancienne à la courante
+    for (int k = 1; k <= kGpuFrames; ++k)
+        readGpuFrame(g_gpu[(g_gpuFrame + k) % kGpuFrames], true);
+    for (GpuFrame& f : g_gpu)
+        glDeleteQueries(kGpuZonesPerFrame, f.query);
+    g_gpuReady = false;
+    g_gpuDepth = 0;
+}
+
+// ---------------------- Moyennes et capture ----------------------
+
+struct ZoneStats {
+    const char* name;
+    bool gpu;
+    double ms[kWindow] = {};
+    int calls[kWindow] = {};
+    double curMs = 0.0;
+    int curCalls = 0;
+};
+
+struct CapturedEvent {
+    Event e;
+    int tid;
+};
+
+// Collecteur : thread de endFrame seulement (report / writeChromeTrace aussi)
+static std::vector<ZoneStats> g_zones;
+static long g_frames = 0;
+static std::vector<CapturedEvent> g_capture;
+static size_t g_captureMax = 0;
+static uint64_t g_captureStart = 0;
+
+static ZoneStats& zoneFor(const char* name, bool gpu)
+{
+    // Même littéral dans deux unités de traduction : pointeurs distincts possibles
+    for (ZoneStats& z : g_zones)
+        if (z.gpu == gpu && (z.name == name || !std::strcmp(z.name, name)))
+            return z;
+    g_zones.push_back(ZoneStats{name, gpu});
+    return g_zones.back();
+}
+
+void endFrame()
+{
+    {
+        std::lock_guard<std::mutex> lk(g_logsM);
+        for (auto& log : g_logs)
+        {
+            const uint32_t t = log->tail.load(std::memory_order_relaxed);
+            const uint32_t h = log->head.load(std::memory_order_acquire);
+            for (uint32_t i = t; i != h; ++i)
+            {
+                const Event& e = log->ring[i & (kRingSize - 1)];
+                ZoneStats& z = zoneFor(e.name, e.gpu);
+                z.curMs += (e.end - e.begin) * 1e-6;
+                ++z.curCalls;
+                if (g_capture.size() < g_captureMax)
+                    g_capture.push_back(CapturedEvent{e, log->tid});
+            }
+            log->tail.store(h, std::memory_order_release);
+        }
+    }
+    const int slot = (int)(g_frames % kWindow);
+    for (ZoneStats& z : g_zones)
+    {
+        z.ms[slot] = z.curMs;
+        z.calls[slot] = z.curCalls;
+        z.curMs = 0.0;
+        z.curCalls = 0;
+    }
+    ++g_frames;
+}
+
+void report(std::ostream& os)
+{
+    const int n = (int)std::min<long>(g_frames, kWindow);
+    if (n == 0)
+        return;
+    uint32_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lk(g_logsM);
+        for (auto& log : g_logs)
+            dropped += log->dropped.load(std::memory_order_relaxed);
+    }
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "  profile (last %d frames, ms/frame):\n", n);
+    os << buf;
+    for (const ZoneStats& z : g_zones)
+    {
+        double sum = 0.0, peak = 0.0;
+        long calls = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            sum += z.ms[i];
+            peak = std::max(peak, z.ms[i]);
+            calls += z.calls[i];
+        }
+        std::snprintf(buf, sizeof(buf), "    %-4s %-14s mean %8.3f  max %8.3f  calls %7.1f\n", z.gpu ? "gpu" : "cpu",
+                      z.name, sum / n, peak, (double)calls / n);
+        os << buf;
+    }
+    if (dropped || g_gpuDropped.load(std::memory_order_relaxed))
+        os << "    dropped: " << dropped << " cpu zones (ring full), " << g_gpuDropped.load() << " gpu zones\n";
+}
+
+void startCapture(size_t maxEvents)
+{
+    g_capture.clear();
+    g_capture.reserve(std::min<size_t>(maxEvents, 1u << 16));
+    g_captureMax = maxEvents;
+    g_captureStart = now();
+}
+
+// Format "Trace Event" : événements complets (ph X), temps en µs. Les zones
+// GPU vont sur une piste à part, placées à leur soumission CPU (le GPU ne
+// donne qu'une durée avec GL_TIME_ELAPSED).
+bool writeChromeTrace(const char* path)
+{
+    std::FILE* f = std::fopen(path, "w");
+    if (!f)
+        return false;
+    const int gpuTid = 0;
+    std::fprintf(f, "{\"traceEvents\": [\n");
+    std::fprintf(f, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"GPU\"}}",
+                 gpuTid);
+    {
+        std::lock_guard<std::mutex> lk(g_logsM);
+        for (auto& log : g_logs)
+            std::fprintf(f, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                            "\"args\": {\"name\": \"%s\"}}",
+                         log->tid, log->name);
+    }
+    for (const CapturedEvent& c : g_capture)
+    {
+        const double ts = (double)(int64_t)(c.e.begin - g_captureStart) * 1e-3;
+        std::fprintf(f, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                        "\"ts\": %.3f, \"dur\": %.3f}",
+                     c.e.name, c.e.gpu ? "gpu" : "cpu", c.e.gpu ? gpuTid : c.tid, ts, (c.e.end - c.e.begin) * 1e-3);
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+
+} // namespace prof
+
+#endif // HUMANGL_PROFILE
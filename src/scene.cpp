@@ -0,0 +1,214 @@
+// scene.cpp
+#include "scene.hpp"
+#include "helper.hpp"
+#include "crowd_data.hpp"
+#include "cube.hpp"
+#include "profiler.hpp"
+#include "shader_utils.hpp"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <string>
+
+// Insère des #define juste après la ligne #version
+static std::string withDefines(const std::string &src, const std::string &defines)
+{
+    if (defines.empty())
+        return src;
+    const size_t eol = src.find('\n');
+    if (eol == std::string::npos)
+        return src + "\n" + defines;
+    return src.substr(0, eol + 1) + defines + src.substr(eol + 1);
+}
+
+static GLuint loadProgram(const char *vsPath, const char *fsPath, const char *cacheDir,
+                          const std::string &defines)
+{
+    std::string vsSrc = withDefines(loadFile(vsPath), defines);
+    std::string fsSrc = loadFile(fsPath);
+    return buildProgram(vsSrc.c_str(), fsSrc.c_str(), cacheDir);
+}
+
+SceneGL loadSceneGL(const char *shaderCache, bool proceduralCube)
+{
+    SceneGL gl;
+    const std::string defines = proceduralCube ? "#define PROCEDURAL_CUBE\n" : "";
+    gl.prog = loadProgram("shaders/simple.vert", "shaders/simple.frag", shaderCache, defines);
+    gl.uModel = glGetUniformLocation(gl.prog, "model");
+    gl.uColor = glGetUniformLocation(gl.prog, "uColor");
+
+    // Programme instancié (mode foule)
+    gl.instProg = loadProgram("shaders/instanced.vert", "shaders/instanced.frag", shaderCache, defines);
+    // Même foule, transformations lues dans un texture buffer (texelFetch)
+    gl.tboProg = loadProgram("shaders/simple.vert", "shaders/instanced.frag", shaderCache,
+                             defines + "#define TBO_INSTANCES\n");
+    bindInstanceSampler(gl.tboProg);
+
+    // Caméra + temps : un seul UBO partagé par tous les programmes
+    gl.frameUBO = createFrameUBO();
+    bindFrameBlock(gl.prog);
+    bindFrameBlock(gl.instProg);
+    bindFrameBlock(gl.tboProg);
+
+    gl.cube.procedural = proceduralCube;
+    gl.cube.vao = proceduralCube ? make_procedural_cube() : make_unit_cube();
+    return gl;
+}
+
+FrameUniforms sceneCamera(int count, float aspect, float time)
+{
+    FrameUniforms f;
+    const float extent = crowdExtent(count);
+    const float d = 1.0f + extent * 0.5f;
+    f.projection = glm::perspective(glm::radians(60.f), aspect, 0.1f, 100.f + extent * 4.0f);
+    f.view = glm::lookAt(glm::vec3(2.5f, 2.0f, 4.0f) * d, glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+    f.viewProj = f.projection * f.view;
+    f.time = glm::vec4(time, 0, 0, 0);
+    return f;
+}
+
+void uploadCamera(SceneGL &gl, int count, float aspect)
+{
+    gl.frame = sceneCamera(count, aspect, gl.frame.time.x);
+}
+
+static void beginFrame(SceneGL &gl, float t)
+{
+    gl.frame.time.x = t;
+    updateFrameUBO(gl.frameUBO, gl.frame);
+
+    glClearColor(kSceneClearColor.x, kSceneClearColor.y, kSceneClearColor.z, kSceneClearColor.w);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+// Tri des commandes puis exécution GL (tables indexées par ProgramId / MeshId)
+static void submitCommands(SceneGL &gl)
+{
+    static_assert(ProgramParts == 0 && MeshCube == 0, "tables ProgramId / MeshId");
+    PROFILE_ZONE("submit");
+    const ProgramSlot programs[] = {{gl.prog, gl.uModel, gl.uColor}};
+    gl.commands.sort();
+    executeGL(gl.commands, programs, &gl.cube);
+}
+
+// Programme du chemin instancié : attributs d'instance ou texture buffer
+static void useInstanced(const SceneGL &gl, const CrowdRenderer &crowd)
+{
+    glstate::useProgram(crowd.textureBuffer() ? gl.tboProg : gl.instProg);
+}
+
+// Une commande par pièce : palette du rig, ou palette de chaque personnage
+// d'une foule variée (character : cf. CrowdCuller::character)
+static void recordParts(CommandBuffer &cmds, const CharacterRenderer &rig, const PartInstance *parts, size_t n,
+                        const uint8_t *partIndex, const uint32_t *)
+{
+    const uint16_t materials = rig.recordMaterials(cmds);
+    rig.record(parts, n, cmds, cmds.allocate(n), materials, partIndex);
+}
+
+static void recordParts(CommandBuffer &cmds, const CrowdData &crowd, const PartInstance *parts, size_t n,
+                        const uint8_t *partIndex, const uint32_t *character)
+{
+    const uint16_t materials = crowd.recordMaterials(cmds);
+    crowd.record(parts, n, cmds, cmds.allocate(n), materials, partIndex, character);
+}
+
+// Pièces retenues par gl.culler (compactées, indices de pièce pour les matériaux)
+template <class Source>
+static void drawCulled(SceneGL &gl, const Source &src, CrowdRenderer &crowd, size_t n, bool instanced)
+{
+    if (instanced)
+    {
+        useInstanced(gl, crowd);
+        crowd.draw(gl.culler.parts(), n);
+    }
+    else
+    {
+        {
+            PROFILE_ZONE("record");
+            gl.commands.clear();
+            recordParts(gl.commands, src, gl.culler.parts(), n, gl.culler.partIndex(), gl.culler.character());
+        }
+        submitCommands(gl);
+    }
+}
+
+void renderScene(SceneGL &gl, const CharacterRenderer &rig, CrowdRenderer &crowd,
+                 int count, bool instanced, float t, const AnimBlend &anim, bool paused)
+{
+    PROFILE_ZONE("draw");
+    PROFILE_GPU_ZONE("draw");
+    beginFrame(gl, t);
+
+    if (gl.culling || gl.lod)
+    {
+        const Frustum frustum = extractFrustum(gl.frame.viewProj);
+        gl.crowdLod.setEye(glm::vec3(glm::inverse(gl.frame.view)[3]));
+        size_t n;
+        {
+            PROFILE_ZONE("pose+cull");
+            n = gl.culler.build(rig, count, t, anim, paused, gl.culling ? &frustum : nullptr, crowd.jobs(),
+                                gl.lod ? &gl.crowdLod : nullptr);
+        }
+        drawCulled(gl, rig, crowd, n, instanced);
+    }
+    else if (instanced)
+    {
+        useInstanced(gl, crowd);
+        crowd.draw(rig, count, t, anim, paused);
+    }
+    else
+    {
+        {
+            PROFILE_ZONE("pose+record");
+            gl.commands.clear();
+            recordCrowd(rig, count, t, anim, paused, gl.commands, crowd.jobs());
+        }
+        submitCommands(gl);
+    }
+}
+
+// Source : CharacterRenderer (foule uniforme) ou CrowdData (foule variée)
+template <class Source>
+static void renderPosed(SceneGL &gl, const Source &src, CrowdRenderer &crowd, const PartInstance *parts, size_t n,
+                        bool instanced, float t)
+{
+    PROFILE_ZONE("draw");
+    PROFILE_GPU_ZONE("draw");
+    beginFrame(gl, t);
+
+    if (gl.culling)
+    {
+        size_t visible;
+        {
+            PROFILE_ZONE("cull");
+            visible = gl.culler.filter(src, parts, n, extractFrustum(gl.frame.viewProj));
+        }
+        drawCulled(gl, src, crowd, visible, instanced);
+    }
+    else if (instanced)
+    {
+        useInstanced(gl, crowd);
+        crowd.draw(parts, n);
+    }
+    else
+    {
+        {
+            PROFILE_ZONE("record");
+            gl.commands.clear();
+            recordParts(gl.commands, src, parts, n, nullptr, nullptr);
+        }
+        submitCommands(gl);
+    }
+}
+
+void renderParts(SceneGL &gl, const CharacterRenderer &rig, CrowdRenderer &crowd,
+                 const PartInstance *parts, size_t n, bool instanced, float t)
+{
+    renderPosed(gl, rig, crowd, parts, n, instanced, t);
+}
+
+void renderParts(SceneGL &gl, const CrowdData &varied, CrowdRenderer &crowd,
+                 const PartInstance *parts, size_t n, bool instanced, float t)
+{
+    renderPosed(gl, varied, crowd, parts, n, instanced, t);
+}
@@ -1,5 +1,12 @@
 #include "shader_utils.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 GLuint compileShader(GLenum type, const char *src)
 {
@@ -17,11 +24,13 @@ GLuint compileShader(GLenum type, const char *src)
     return s;
 }
 
-GLuint linkProgram(GLuint vs, GLuint fs)
+GLuint linkProgram(GLuint vs, GLuint fs, bool retrievable)
 {
     GLuint p = glCreateProgram();
     glAttachShader(p, vs);
     glAttachShader(p, fs);
+    if (retrievable)
+        glProgramParameteri(p, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(p);
     GLint ok;
     glGetProgramiv(p, GL_LINK_STATUS, &ok);
@@ -35,3 +44,135 @@ GLuint linkProgram(GLuint vs, GLuint fs)
     glDeleteShader(fs);
     return p;
 }
+
+// ---------------------- Cache des binaires de programme ----------------------
+
+ProgramCacheStats g_programCache;
+
+namespace
+{
+struct CacheHeader
+{
+    char magic[8];
+    std::uint64_t key;
+    std::uint32_t format;
+    std::uint32_t size;
+};
+const char kCacheMagic[8] = {'H', 'G', 'L', 'P', 'B', 'I', 'N', '1'};
+
+// FNV-1a 64 bits, chaîne terminée incluse (sépare les champs)
+void hashStr(std::uint64_t &h, const char *s)
+{
+    do
+    {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ull;
+    } while (*s++);
+}
+
+std::uint64_t programKey(const char *vsSrc, const char *fsSrc)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    hashStr(h, vsSrc);
+    hashStr(h, fsSrc);
+    for (GLenum e : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const char *s = (const char *)glGetString(e);
+        hashStr(h, s ? s : "");
+    }
+    return h;
+}
+
+std::string cachePath(const char *dir, std::uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)key);
+    return std::string(dir) + name;
+}
+
+bool linked(GLuint p)
+{
+    GLint ok = GL_FALSE;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    return ok == GL_TRUE;
+}
+
+GLuint loadBinary(const std::string &path, std::uint64_t key)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        return 0;
+    const std::streamoff fileSize = in.tellg();
+    in.seekg(0);
+    CacheHeader h;
+    if (!in.read((char *)&h, sizeof(h)) || std::memcmp(h.magic, kCacheMagic, 8) || h.key != key)
+        return 0;
+    // Fichier tronqué ou corrompu : la taille annoncée doit être exactement le reste
+    if (h.size == 0 || (std::streamoff)h.size != fileSize - (std::streamoff)sizeof(h))
+        return 0;
+    std::vector<char> blob(h.size);
+    if (!in.read(blob.data(), blob.size()))
+        return 0;
+
+    GLuint p = glCreateProgram();
+    glProgramBinary(p, h.format, blob.data(), (GLsizei)blob.size());
+    if (!linked(p)) // format refusé (driver mis à jour…)
+    {
+        glDeleteProgram(p);
+        return 0;
+    }
+    return p;
+}
+
+void storeBinary(const char *dir, const std::string &path, std::uint64_t key, GLuint p)
+{
+    GLint len = 0;
+    glGetProgramiv(p, GL_PROGRAM_BINARY_LENGTH, &len);
+    if (len <= 0)
+        return;
+    std::vector<char> blob(len);
+    GLenum format = 0;
+    glGetProgramBinary(p, len, nullptr, &format, blob.data());
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    CacheHeader h;
+    std::memcpy(h.magic, kCacheMagic, 8);
+    h.key = key;
+    h.format = format;
+    h.size = (std::uint32_t)len;
+    out.write((const char *)&h, sizeof(h));
+    out.write(blob.data(), blob.size());
+    if (!out)
+        std::cerr << "Shader cache: cannot write " << path << std::endl;
+}
+} // namespace
+
+GLuint buildProgram(const char *vsSrc, const char *fsSrc, const char *cacheDir)
+{
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    const bool useCache = cacheDir && formats > 0;
+
+    std::uint64_t key = 0;
+    std::string path;
+    if (useCache)
+    {
+        key = programKey(vsSrc, fsSrc);
+        path = cachePath(cacheDir, key);
+        if (GLuint p = loadBinary(path, key))
+        {
+            ++g_programCache.hits;
+            return p;
+        }
+    }
+
+    ++g_programCache.misses;
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vsSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSrc);
+    GLuint p = linkProgram(vs, fs, useCache);
+    if (useCache && linked(p))
+        storeBinary(cacheDir, path, key, p);
+    return p;
+}
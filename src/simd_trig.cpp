@@ -0,0 +1,198 @@
+// simd_trig.cpp
+#include "simd_trig.hpp"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(SIMD_TRIG_SCALAR)
+#define SIMD_TRIG_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(SIMD_TRIG_SCALAR)
+#define SIMD_TRIG_NEON 1
+#include <arm_neon.h>
+#endif
+
+// π/2 en trois morceaux : j * kPio2A exact pour |j| < 2^15
+static const float kTwoOverPi = 0.636619772367581343f;
+static const float kPio2A = 1.5703125f;
+static const float kPio2B = 4.837512969970703125e-4f;
+static const float kPio2C = 7.54978995489188216e-8f;
+
+// sin(r), cos(r) sur [-π/4, π/4] (Cephes sinf / cosf)
+static const float kS1 = -1.6666654611e-1f, kS2 = 8.3321608736e-3f, kS3 = -1.9515295891e-4f;
+static const float kC1 = 4.166664568298827e-2f, kC2 = -1.388731625493765e-3f, kC3 = 2.443315711809948e-5f;
+
+// ---------------------- Noyau scalaire (référence des noyaux SIMD) ----------------------
+
+// quadrant = 1 : cos(x) = sin(x + π/2), même réduction, quadrant décalé
+static float sinQuadrant(float x, int quadrant)
+{
+    // Quadrant j = arrondi au plus proche (pair en cas d'égalité, comme cvtps2dq)
+    const float j = std::nearbyint(x * kTwoOverPi);
+    const int q = (int)j + quadrant;
+    const float r = ((x - j * kPio2A) - j * kPio2B) - j * kPio2C;
+    const float r2 = r * r;
+    const float s = r + r * r2 * (kS1 + r2 * (kS2 + r2 * kS3));
+    const float c = 1.0f - 0.5f * r2 + r2 * r2 * (kC1 + r2 * (kC2 + r2 * kC3));
+    // sin(r + jπ/2) : sin, cos, -sin, -cos
+    const float v = (q & 1) ? c : s;
+    return (q & 2) ? -v : v;
+}
+
+float sinApprox(float x)
+{
+    return sinQuadrant(x, 0);
+}
+
+float cosApprox(float x)
+{
+    return sinQuadrant(x, 1);
+}
+
+static void sinScalar(const float *x, float *out, size_t n, int quadrant)
+{
+    for (size_t i = 0; i < n; ++i)
+        out[i] = sinQuadrant(x[i], quadrant);
+}
+
+// ---------------------- Noyaux SIMD ----------------------
+
+#ifdef SIMD_TRIG_X86
+static void sinSSE2(const float *x, float *out, size_t n, int quadrant)
+{
+    const __m128 twoOverPi = _mm_set1_ps(kTwoOverPi);
+    const __m128 pa = _mm_set1_ps(kPio2A), pb = _mm_set1_ps(kPio2B), pc = _mm_set1_ps(kPio2C);
+    const __m128 one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f);
+    const __m128i bit0 = _mm_set1_epi32(1), offset = _mm_set1_epi32(quadrant);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 v = _mm_loadu_ps(x + i);
+        const __m128i jq = _mm_cvtps_epi32(_mm_mul_ps(v, twoOverPi));
+        const __m128 j = _mm_cvtepi32_ps(jq);
+        const __m128i q = _mm_add_epi32(jq, offset);
+        const __m128 r = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(v, _mm_mul_ps(j, pa)), _mm_mul_ps(j, pb)), _mm_mul_ps(j, pc));
+        const __m128 r2 = _mm_mul_ps(r, r);
+        __m128 ps = _mm_add_ps(_mm_set1_ps(kS2), _mm_mul_ps(r2, _mm_set1_ps(kS3)));
+        ps = _mm_add_ps(_mm_set1_ps(kS1), _mm_mul_ps(r2, ps));
+        ps = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), ps));
+        __m128 pcos = _mm_add_ps(_mm_set1_ps(kC2), _mm_mul_ps(r2, _mm_set1_ps(kC3)));
+        pcos = _mm_add_ps(_mm_set1_ps(kC1), _mm_mul_ps(r2, pcos));
+        pcos = _mm_add_ps(_mm_sub_ps(one, _mm_mul_ps(half, r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), pcos));
+        // Quadrant impair → cos ; bit 1 → signe (bit 1 de q décalé sur le bit de signe)
+        const __m128 odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, bit0), bit0));
+        const __m128 res = _mm_or_ps(_mm_and_ps(odd, pcos), _mm_andnot_ps(odd, ps));
+        const __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(q, 1), 31));
+        _mm_storeu_ps(out + i, _mm_xor_ps(res, sign));
+    }
+    sinScalar(x + i, out + i, n - i, quadrant);
+}
+
+__attribute__((target("avx2"))) static void sinAVX2(const float *x, float *out, size_t n, int quadrant)
+{
+    const __m256 twoOverPi = _mm256_set1_ps(kTwoOverPi);
+    const __m256 pa = _mm256_set1_ps(kPio2A), pb = _mm256_set1_ps(kPio2B), pc = _mm256_set1_ps(kPio2C);
+    const __m256 one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f);
+    const __m256i bit0 = _mm256_set1_epi32(1), offset = _mm256_set1_epi32(quadrant);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 v = _mm256_loadu_ps(x + i);
+        const __m256i jq = _mm256_cvtps_epi32(_mm256_mul_ps(v, twoOverPi));
+        const __m256 j = _mm256_cvtepi32_ps(jq);
+        const __m256i q = _mm256_add_epi32(jq, offset);
+        const __m256 r = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(v, _mm256_mul_ps(j, pa)), _mm256_mul_ps(j, pb)),
+                                       _mm256_mul_ps(j, pc));
+        const __m256 r2 = _mm256_mul_ps(r, r);
+        __m256 ps = _mm256_add_ps(_mm256_set1_ps(kS2), _mm256_mul_ps(r2, _mm256_set1_ps(kS3)));
+        ps = _mm256_add_ps(_mm256_set1_ps(kS1), _mm256_mul_ps(r2, ps));
+        ps = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), ps));
+        __m256 pcos = _mm256_add_ps(_mm256_set1_ps(kC2), _mm256_mul_ps(r2, _mm256_set1_ps(kC3)));
+        pcos = _mm256_add_ps(_mm256_set1_ps(kC1), _mm256_mul_ps(r2, pcos));
+        pcos = _mm256_add_ps(_mm256_sub_ps(one, _mm256_mul_ps(half, r2)), _mm256_mul_ps(_mm256_mul_ps(r2, r2), pcos));
+        const __m256 odd = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, bit0), bit0));
+        const __m256 res = _mm256_blendv_ps(ps, pcos, odd);
+        const __m256 sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(q, 1), 31));
+        _mm256_storeu_ps(out + i, _mm256_xor_ps(res, sign));
+    }
+    sinScalar(x + i, out + i, n - i, quadrant);
+}
+#endif
+
+#ifdef SIMD_TRIG_NEON
+static void sinNEON(const float *x, float *out, size_t n, int quadrant)
+{
+    const float32x4_t twoOverPi = vdupq_n_f32(kTwoOverPi);
+    const float32x4_t pa = vdupq_n_f32(kPio2A), pb = vdupq_n_f32(kPio2B), pc = vdupq_n_f32(kPio2C);
+    const float32x4_t one = vdupq_n_f32(1.0f), half = vdupq_n_f32(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const float32x4_t v = vld1q_f32(x + i);
+        const int32x4_t jq = vcvtnq_s32_f32(vmulq_f32(v, twoOverPi));
+        const float32x4_t j = vcvtq_f32_s32(jq);
+        const int32x4_t q = vaddq_s32(jq, vdupq_n_s32(quadrant));
+        const float32x4_t r = vsubq_f32(vsubq_f32(vsubq_f32(v, vmulq_f32(j, pa)), vmulq_f32(j, pb)), vmulq_f32(j, pc));
+        const float32x4_t r2 = vmulq_f32(r, r);
+        float32x4_t ps = vaddq_f32(vdupq_n_f32(kS2), vmulq_f32(r2, vdupq_n_f32(kS3)));
+        ps = vaddq_f32(vdupq_n_f32(kS1), vmulq_f32(r2, ps));
+        ps = vaddq_f32(r, vmulq_f32(vmulq_f32(r, r2), ps));
+        float32x4_t pcos = vaddq_f32(vdupq_n_f32(kC2), vmulq_f32(r2, vdupq_n_f32(kC3)));
+        pcos = vaddq_f32(vdupq_n_f32(kC1), vmulq_f32(r2, pcos));
+        pcos = vaddq_f32(vsubq_f32(one, vmulq_f32(half, r2)), vmulq_f32(vmulq_f32(r2, r2), pcos));
+        const uint32x4_t odd = vtstq_s32(q, vdupq_n_s32(1));
+        const float32x4_t res = vbslq_f32(odd, pcos, ps);
+        const uint32x4_t neg = vtstq_s32(q, vdupq_n_s32(2));
+        vst1q_f32(out + i, vbslq_f32(neg, vnegq_f32(res), res));
+    }
+    sinScalar(x + i, out + i, n - i, quadrant);
+}
+#endif
+
+// ---------------------- Dispatch ----------------------
+
+namespace
+{
+using SinKernel = void (*)(const float *, float *, size_t, int);
+
+struct TrigKernel {
+    SinKernel fn = sinScalar;
+    const char *isa = "scalar";
+
+    TrigKernel()
+    {
+#ifdef SIMD_TRIG_X86
+        fn = sinSSE2;
+        isa = "sse2";
+        if (__builtin_cpu_supports("avx2"))
+        {
+            fn = sinAVX2;
+            isa = "avx2";
+        }
+#elif defined(SIMD_TRIG_NEON)
+        fn = sinNEON;
+        isa = "neon";
+#endif
+    }
+};
+
+// Choisi une fois (init statique thread-safe), au premier appel
+const TrigKernel &kernel()
+{
+    static const TrigKernel k;
+    return k;
+}
+} // namespace
+
+void sinBatch(const float *x, float *out, size_t n)
+{
+    kernel().fn(x, out, n, 0);
+}
+
+void cosBatch(const float *x, float *out, size_t n)
+{
+    kernel().fn(x, out, n, 1);
+}
+
+const char *trigIsa()
+{
+    return kernel().isa;
+}
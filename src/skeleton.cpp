@@ -0,0 +1,170 @@
+// skeleton.cpp
+#include "skeleton.hpp"
+#include "character.hpp"
+#include <algorithm>
+#include <cassert>
+
+void Skeleton::clear()
+{
+    parent.clear();
+    offset.clear();
+    transAxis.clear();
+    transChannel.clear();
+    axis.clear();
+    rotChannel.clear();
+    rotSign.clear();
+    partJoint.clear();
+    partCenter.clear();
+    partScale.clear();
+    partColor.clear();
+}
+
+size_t Skeleton::heapBytes() const
+{
+    auto bytes = [](const auto &v) { return v.capacity() * sizeof(v[0]); };
+    return bytes(parent) + bytes(offset) + bytes(transAxis) + bytes(transChannel) + bytes(axis) +
+           bytes(rotChannel) + bytes(rotSign) + bytes(partJoint) + bytes(partCenter) + bytes(partScale) +
+           bytes(partColor);
+}
+
+int Skeleton::addJoint(int parentIdx, const glm::vec3 &off, int rotCh, float sign, const glm::vec3 &rotAxis)
+{
+    // Tri topologique par construction : le parent doit déjà exister
+    assert(parentIdx < jointCount());
+    assert(jointCount() < kMaxJoints);
+    parent.push_back(parentIdx);
+    offset.push_back(off);
+    transAxis.push_back({0.0f, 0.0f, 0.0f});
+    transChannel.push_back(-1);
+    axis.push_back(rotAxis);
+    rotChannel.push_back(rotCh);
+    rotSign.push_back(sign);
+    return jointCount() - 1;
+}
+
+void Skeleton::addPart(int joint, const glm::vec3 &center, const glm::vec3 &scale, int color)
+{
+    assert(joint < jointCount());
+    assert(partCount() < kMaxParts);
+    partJoint.push_back(joint);
+    partCenter.push_back(center);
+    partScale.push_back(scale);
+    partColor.push_back(color);
+}
+
+void Skeleton::computeWorld(const AnimChannels &ch, const Affine3x4 &root, Affine3x4 *world) const
+{
+    const int n = jointCount();
+    for (int i = 0; i < n; ++i)
+    {
+        glm::vec3 t = offset[i];
+        if (transChannel[i] >= 0)
+            t += transAxis[i] * ch[transChannel[i]];
+        // Même suite d'opérations que l'ancienne pile (translate puis rotate à
+        // droite), fusionnée en une composition
+        const Affine3x4 &p = parent[i] < 0 ? root : world[parent[i]];
+        if (rotChannel[i] >= 0)
+            world[i] = translateRotate(p, t, rotSign[i] * ch[rotChannel[i]], axis[i]);
+        else
+            world[i] = translate(p, t);
+    }
+}
+
+void Skeleton::computeWorldLocal(const glm::quat *rot, const glm::vec3 *trans, const Affine3x4 &root,
+                                 Affine3x4 *world) const
+{
+    const int n = jointCount();
+    for (int i = 0; i < n; ++i)
+    {
+        const Affine3x4 &p = parent[i] < 0 ? root : world[parent[i]];
+        world[i] = translateRotate(p, offset[i] + trans[i], glm::mat3_cast(rot[i]));
+    }
+}
+
+void Skeleton::computeParts(const Affine3x4 *world, Affine3x4 *models) const
+{
+    const int n = partCount();
+    for (int i = 0; i < n; ++i)
+        models[i] = translateScale(world[partJoint[i]], partCenter[i], partScale[i]);
+}
+
+float Skeleton::boundRadius(float maxTrans) const
+{
+    float reach[kMaxJoints];
+    for (int i = 0; i < jointCount(); ++i)
+    {
+        assert((i == 0) == (parent[i] < 0));
+        reach[i] = i == 0 ? 0.0f : reach[parent[i]] + glm::length(offset[i]);
+        if (i > 0 && transChannel[i] >= 0)
+            reach[i] += glm::length(transAxis[i]) * maxTrans;
+    }
+    float r = 0.0f;
+    for (int i = 0; i < partCount(); ++i)
+        r = std::max(r, reach[partJoint[i]] + glm::length(partCenter[i]) + 0.5f * glm::length(partScale[i]));
+    return r;
+}
+
+// ---------------------- Humanoïde (ex-helpers place*) ----------------------
+
+void buildHumanoid(const RigParams &P, Skeleton &S)
+{
+    S.clear();
+
+    // Racine = centre du torse : rebond vertical + légère oscillation autour de Y
+    const int torso = S.addJoint(-1, {0.0f, 0.0f, 0.0f}, ChSway, 1.0f, {0, 1, 0});
+    S.transAxis[torso] = {0.0f, 1.0f, 0.0f};
+    S.transChannel[torso] = ChBounce;
+
+    // placeTorso / placeHeadFromTorso
+    S.addPart(torso, {0.0f, 0.0f, 0.0f}, {P.torsoW, P.torsoH, P.torsoD}, SlotTorso);
+    S.addPart(torso, {0.0f, P.torsoH * 0.5f + P.headH * 0.5f, 0.0f},
+              {P.headH * 0.8f, P.headH, P.headH * 0.8f}, SlotHead);
+
+    // Bras : pivot d'épaule (rotation -walk à droite, +walk à gauche), puis coude
+    const float shoulderX = P.torsoW * 0.5f + P.armR;
+    for (float side : {+1.0f, -1.0f})
+    {
+        const int shoulder = S.addJoint(torso, {side * shoulderX, P.torsoH * 0.35f, 0.0f}, ChWalk, -side);
+        const int elbow = S.addJoint(shoulder, {0.0f, -P.upperArmL, 0.0f}, ChElbow, side);
+        // placeUpperArm / placeForearm
+        S.addPart(shoulder, {0.0f, -P.upperArmL * 0.5f, 0.0f}, {P.armR, P.upperArmL, P.armR}, SlotArm);
+        S.addPart(elbow, {0.0f, -P.foreArmL * 0.5f, 0.0f},
+                  {P.armR * 0.95f, P.foreArmL, P.armR * 0.95f}, SlotArm);
+    }
+
+    // Jambes : pivot de hanche (+hip à droite, -hip à gauche), genoux identiques
+    for (float side : {+1.0f, -1.0f})
+    {
+        const int hip = S.addJoint(torso, {side * P.torsoW * 0.25f, -P.torsoH * 0.5f, 0.0f}, ChHip, side);
+        const int knee = S.addJoint(hip, {0.0f, -P.thighL, 0.0f}, ChKnee, 1.0f);
+        // placeThigh / placeShin
+        S.addPart(hip, {0.0f, -P.thighL * 0.5f, 0.0f}, {P.legR, P.thighL, P.legR}, SlotLeg);
+        S.addPart(knee, {0.0f, -P.shinL * 0.5f, 0.0f}, {P.legR * 0.95f, P.shinL, P.legR * 0.95f}, SlotLeg);
+    }
+}
+
+void buildHumanoidMerged(const RigParams &P, Skeleton &S)
+{
+    S.clear();
+
+    const int torso = S.addJoint(-1, {0.0f, 0.0f, 0.0f}, ChSway, 1.0f, {0, 1, 0});
+    S.transAxis[torso] = {0.0f, 1.0f, 0.0f};
+    S.transChannel[torso] = ChBounce;
+    S.addPart(torso, {0.0f, 0.0f, 0.0f}, {P.torsoW, P.torsoH, P.torsoD}, SlotTorso);
+    S.addPart(torso, {0.0f, P.torsoH * 0.5f + P.headH * 0.5f, 0.0f},
+              {P.headH * 0.8f, P.headH, P.headH * 0.8f}, SlotHead);
+
+    // Un bloc par membre, du pivot d'épaule / de hanche jusqu'à la main / au pied
+    const float shoulderX = P.torsoW * 0.5f + P.armR;
+    const float armL = P.upperArmL + P.foreArmL, legL = P.thighL + P.shinL;
+    for (float side : {+1.0f, -1.0f})
+    {
+        const int shoulder = S.addJoint(torso, {side * shoulderX, P.torsoH * 0.35f, 0.0f}, ChWalk, -side);
+        S.addPart(shoulder, {0.0f, -armL * 0.5f, 0.0f}, {P.armR, armL, P.armR}, SlotArm);
+    }
+    for (float side : {+1.0f, -1.0f})
+    {
+        const int hip = S.addJoint(torso, {side * P.torsoW * 0.25f, -P.torsoH * 0.5f, 0.0f}, ChHip, side);
+        S.addPart(hip, {0.0f, -legL * 0.5f, 0.0f}, {P.legR, legL, P.legR}, SlotLeg);
+    }
+}
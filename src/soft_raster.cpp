@@ -0,0 +1,459 @@
+// soft_raster.cpp
+#include "soft_raster.hpp"
+#include "jobs.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(SOFT_RASTER_SCALAR)
+#define SOFT_RASTER_X86 1
+#include <immintrin.h>
+#endif
+
+// ---------------------- Framebuffer ----------------------
+
+void SoftFramebuffer::resize(int w, int h)
+{
+    assert(w > 0 && h > 0 && w <= kSoftMaxSize && h <= kSoftMaxSize);
+    width = w;
+    height = h;
+    stride = (w + kSoftTile - 1) / kSoftTile * kSoftTile;
+    const size_t rows = (size_t)(h + kSoftTile - 1) / kSoftTile * kSoftTile;
+    color.assign((size_t)stride * rows, 0);
+    depth.assign((size_t)stride * rows, 1.0f);
+}
+
+void SoftFramebuffer::readPixels(std::vector<uint32_t> &out) const
+{
+    out.resize((size_t)width * height);
+    for (int y = 0; y < height; ++y)
+        std::memcpy(&out[(size_t)y * width], &color[(size_t)y * stride], width * sizeof(uint32_t));
+}
+
+// Conversion float → unorm8 comme GL (arrondi au plus proche)
+static uint32_t packRGBA(const glm::vec4 &c)
+{
+    auto u8 = [](float v)
+    { return (uint32_t)(std::min(1.0f, std::max(0.0f, v)) * 255.0f + 0.5f); };
+    return u8(c.x) | u8(c.y) << 8 | u8(c.z) << 16 | u8(c.w) << 24;
+}
+
+// ---------------------- Noyaux ----------------------
+
+// Triangle ∩ tuile. x0 est aligné sur 8 : les blocs SIMD restent dans la
+// tuile (les pixels hors boîte englobante échouent au test des arêtes).
+// Une arête qui couvre toute la zone a e = dx = dy = 0. La profondeur est
+// recalculée depuis le début de ligne (pas d'accumulation) : les trois
+// noyaux donnent la même image au bit près.
+struct SoftRasterizer::Span {
+    int x0, y0, x1, y1;
+    int32_t e[3], dx[3], dy[3]; // valeur en (x0, y0), pas par pixel
+    float z, zdx, zdy;
+    uint32_t color;
+};
+
+static void spanScalar(const SoftRasterizer::Span &s, SoftFramebuffer &fb)
+{
+    for (int y = s.y0; y <= s.y1; ++y)
+    {
+        const int r = y - s.y0;
+        int32_t e0 = s.e[0] + r * s.dy[0], e1 = s.e[1] + r * s.dy[1], e2 = s.e[2] + r * s.dy[2];
+        const float zRow = s.z + r * s.zdy;
+        float *depth = &fb.depth[(size_t)y * fb.stride];
+        uint32_t *color = &fb.color[(size_t)y * fb.stride];
+        for (int x = s.x0; x <= s.x1; ++x)
+        {
+            const float z = zRow + (x - s.x0) * s.zdx;
+            if ((e0 | e1 | e2) >= 0 && z < depth[x])
+            {
+                depth[x] = z;
+                color[x] = s.color;
+            }
+            e0 += s.dx[0];
+            e1 += s.dx[1];
+            e2 += s.dx[2];
+        }
+    }
+}
+
+#ifdef SOFT_RASTER_X86
+static void spanSSE2(const SoftRasterizer::Span &s, SoftFramebuffer &fb)
+{
+    const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 zdx = _mm_set1_ps(s.zdx);
+    __m128i step[3], dx4[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        step[i] = _mm_setr_epi32(0, s.dx[i], 2 * s.dx[i], 3 * s.dx[i]); // pas de mullo en SSE2
+        dx4[i] = _mm_set1_epi32(4 * s.dx[i]);
+    }
+    const __m128 col = _mm_castsi128_ps(_mm_set1_epi32((int)s.color));
+
+    for (int y = s.y0; y <= s.y1; ++y)
+    {
+        const int r = y - s.y0;
+        __m128i e0 = _mm_add_epi32(_mm_set1_epi32(s.e[0] + r * s.dy[0]), step[0]);
+        __m128i e1 = _mm_add_epi32(_mm_set1_epi32(s.e[1] + r * s.dy[1]), step[1]);
+        __m128i e2 = _mm_add_epi32(_mm_set1_epi32(s.e[2] + r * s.dy[2]), step[2]);
+        const __m128 zRow = _mm_set1_ps(s.z + r * s.zdy);
+        float *depth = &fb.depth[(size_t)y * fb.stride];
+        float *color = (float *)&fb.color[(size_t)y * fb.stride];
+        for (int x = s.x0; x <= s.x1; x += 4)
+        {
+            // bit de signe du OU des trois arêtes : au moins une négative → dehors
+            const __m128i out = _mm_srai_epi32(_mm_or_si128(e0, _mm_or_si128(e1, e2)), 31);
+            const __m128 z = _mm_add_ps(zRow, _mm_mul_ps(_mm_add_ps(lanes, _mm_set1_ps((float)(x - s.x0))), zdx));
+            const __m128 d = _mm_loadu_ps(depth + x);
+            const __m128 m = _mm_andnot_ps(_mm_castsi128_ps(out), _mm_cmplt_ps(z, d));
+            if (_mm_movemask_ps(m))
+            {
+                _mm_storeu_ps(depth + x, _mm_or_ps(_mm_and_ps(m, z), _mm_andnot_ps(m, d)));
+                const __m128 c = _mm_loadu_ps(color + x);
+                _mm_storeu_ps(color + x, _mm_or_ps(_mm_and_ps(m, col), _mm_andnot_ps(m, c)));
+            }
+            e0 = _mm_add_epi32(e0, dx4[0]);
+            e1 = _mm_add_epi32(e1, dx4[1]);
+            e2 = _mm_add_epi32(e2, dx4[2]);
+        }
+    }
+}
+
+__attribute__((target("avx2"))) static void spanAVX2(const SoftRasterizer::Span &s, SoftFramebuffer &fb)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 lanesF = _mm256_cvtepi32_ps(lanes);
+    const __m256 zdx = _mm256_set1_ps(s.zdx);
+    __m256i step[3], dx8[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        step[i] = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(s.dx[i]));
+        dx8[i] = _mm256_set1_epi32(8 * s.dx[i]);
+    }
+    const __m256 col = _mm256_castsi256_ps(_mm256_set1_epi32((int)s.color));
+
+    for (int y = s.y0; y <= s.y1; ++y)
+    {
+        const int r = y - s.y0;
+        __m256i e0 = _mm256_add_epi32(_mm256_set1_epi32(s.e[0] + r * s.dy[0]), step[0]);
+        __m256i e1 = _mm256_add_epi32(_mm256_set1_epi32(s.e[1] + r * s.dy[1]), step[1]);
+        __m256i e2 = _mm256_add_epi32(_mm256_set1_epi32(s.e[2] + r * s.dy[2]), step[2]);
+        const __m256 zRow = _mm256_set1_ps(s.z + r * s.zdy);
+        float *depth = &fb.depth[(size_t)y * fb.stride];
+        float *color = (float *)&fb.color[(size_t)y * fb.stride];
+        for (int x = s.x0; x <= s.x1; x += 8)
+        {
+            const __m256i out = _mm256_srai_epi32(_mm256_or_si256(e0, _mm256_or_si256(e1, e2)), 31);
+            const __m256 z = _mm256_add_ps(zRow, _mm256_mul_ps(_mm256_add_ps(lanesF, _mm256_set1_ps((float)(x - s.x0))), zdx));
+            const __m256 d = _mm256_loadu_ps(depth + x);
+            const __m256 m = _mm256_andnot_ps(_mm256_castsi256_ps(out), _mm256_cmp_ps(z, d, _CMP_LT_OQ));
+            if (_mm256_movemask_ps(m))
+            {
+                _mm256_storeu_ps(depth + x, _mm256_blendv_ps(d, z, m));
+                _mm256_storeu_ps(color + x, _mm256_blendv_ps(_mm256_loadu_ps(color + x), col, m));
+            }
+            e0 = _mm256_add_epi32(e0, dx8[0]);
+            e1 = _mm256_add_epi32(e1, dx8[1]);
+            e2 = _mm256_add_epi32(e2, dx8[2]);
+        }
+    }
+}
+#endif
+
+SoftRasterizer::SoftRasterizer()
+{
+    kernel_ = spanScalar;
+#ifdef SOFT_RASTER_X86
+    kernel_ = spanSSE2;
+    isa_ = "sse2";
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernel_ = spanAVX2;
+        isa_ = "avx2";
+    }
+#endif
+}
+
+// ---------------------- Setup ----------------------
+
+namespace
+{
+// Mêmes coins que make_unit_cube ; faces orientées CCW vues de l'extérieur
+const float kCorner[8][3] = {{-0.5f, -0.5f, -0.5f}, {+0.5f, -0.5f, -0.5f}, {+0.5f, +0.5f, -0.5f},
+                             {-0.5f, +0.5f, -0.5f}, {-0.5f, -0.5f, +0.5f}, {+0.5f, -0.5f, +0.5f},
+                             {+0.5f, +0.5f, +0.5f}, {-0.5f, +0.5f, +0.5f}};
+const int kFace[12][3] = {{0, 3, 2}, {2, 1, 0}, {4, 5, 6}, {6, 7, 4}, {0, 4, 7}, {7, 3, 0},
+                          {1, 2, 6}, {6, 5, 1}, {3, 7, 6}, {6, 2, 3}, {0, 1, 5}, {5, 4, 0}};
+
+const int kSubBits = 4;
+const int kSub = 1 << kSubBits;
+const float kGuardPx = 4096.0f; // |x| et |y| écran (depuis le centre) après clipping
+
+// Bits 0..5 : frustum (rejet), 6..9 : bande de garde, 4 : near (clipping)
+enum : unsigned {
+    OutFrustum = 0x3F,
+    OutNear = 1u << 4,
+    OutGuard = 0xFu << 6,
+};
+
+struct Viewport {
+    int w, h;
+    float gx, gy; // bande de garde en unités de w (clip space)
+};
+
+unsigned outcode(const glm::vec4 &v, const Viewport &vp)
+{
+    unsigned c = 0;
+    c |= (v.x < -v.w) << 0;
+    c |= (v.x > v.w) << 1;
+    c |= (v.y < -v.w) << 2;
+    c |= (v.y > v.w) << 3;
+    c |= (v.z < -v.w) << 4;
+    c |= (v.z > v.w) << 5;
+    c |= (v.x < -vp.gx * v.w) << 6;
+    c |= (v.x > vp.gx * v.w) << 7;
+    c |= (v.y < -vp.gy * v.w) << 8;
+    c |= (v.y > vp.gy * v.w) << 9;
+    return c;
+}
+
+// Triangle en clip space (déjà dans la bande de garde, w > 0) → Tri
+void setupTri(const glm::vec4 &c0, const glm::vec4 &c1, const glm::vec4 &c2, bool mirrored,
+              uint32_t color, const Viewport &vp, std::vector<SoftRasterizer::Tri> &out)
+{
+    const glm::vec4 *c[3] = {&c0, &c1, &c2};
+    int32_t X[3], Y[3];
+    float Z[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const float iw = 1.0f / c[i]->w;
+        X[i] = (int32_t)std::lrint((c[i]->x * iw * 0.5f + 0.5f) * vp.w * kSub);
+        Y[i] = (int32_t)std::lrint((c[i]->y * iw * 0.5f + 0.5f) * vp.h * kSub);
+        Z[i] = c[i]->z * iw * 0.5f + 0.5f;
+    }
+    int64_t area = (int64_t)(X[1] - X[0]) * (Y[2] - Y[0]) - (int64_t)(X[2] - X[0]) * (Y[1] - Y[0]);
+    if (mirrored)
+        area = -area;
+    if (area <= 0) // face arrière ou dégénéré
+        return;
+    if (mirrored)
+    {
+        std::swap(X[1], X[2]);
+        std::swap(Y[1], Y[2]);
+        std::swap(Z[1], Z[2]);
+    }
+
+    // Centres de pixel en (16 px + 8) : boîte = centres compris dans l'étendue
+    SoftRasterizer::Tri t;
+    const int32_t minX = std::min({X[0], X[1], X[2]}), maxX = std::max({X[0], X[1], X[2]});
+    const int32_t minY = std::min({Y[0], Y[1], Y[2]}), maxY = std::max({Y[0], Y[1], Y[2]});
+    t.x0 = std::max(0, (minX - kSub / 2 + kSub - 1) >> kSubBits);
+    t.x1 = std::min(vp.w - 1, (maxX - kSub / 2) >> kSubBits);
+    t.y0 = std::max(0, (minY - kSub / 2 + kSub - 1) >> kSubBits);
+    t.y1 = std::min(vp.h - 1, (maxY - kSub / 2) >> kSubBits);
+    if (t.x0 > t.x1 || t.y0 > t.y1)
+        return;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const int a = i, b = (i + 1) % 3;
+        t.A[i] = Y[a] - Y[b];
+        t.B[i] = X[b] - X[a];
+        t.C[i] = -((int64_t)t.A[i] * X[a] + (int64_t)t.B[i] * Y[a]);
+        // Top-left (repère y vers le haut, CCW) : arête gauche = descendante,
+        // arête haute = horizontale vers -x. Les autres excluent leurs pixels.
+        const bool topLeft = t.A[i] > 0 || (t.A[i] == 0 && t.B[i] < 0);
+        if (!topLeft)
+            t.C[i] -= 1;
+    }
+
+    // Plan de profondeur (affine en espace écran), en pixels
+    const double x0 = X[0] / (double)kSub, y0 = Y[0] / (double)kSub;
+    const double x1 = X[1] / (double)kSub - x0, y1 = Y[1] / (double)kSub - y0;
+    const double x2 = X[2] / (double)kSub - x0, y2 = Y[2] / (double)kSub - y0;
+    const double z1 = Z[1] - Z[0], z2 = Z[2] - Z[0];
+    const double inv = 1.0 / (x1 * y2 - x2 * y1);
+    const double zdx = (z1 * y2 - z2 * y1) * inv;
+    const double zdy = (z2 * x1 - z1 * x2) * inv;
+    t.zdx = (float)zdx;
+    t.zdy = (float)zdy;
+    t.z = (float)(Z[0] + (t.x0 + 0.5 - x0) * zdx + (t.y0 + 0.5 - y0) * zdy);
+    t.color = color;
+    out.push_back(t);
+}
+
+// Sutherland-Hodgman contre near et la bande de garde, puis éventail
+void clipTri(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c, bool mirrored, uint32_t color,
+             const Viewport &vp, std::vector<SoftRasterizer::Tri> &out)
+{
+    // Plans p tels que dot(p, v) >= 0 à l'intérieur
+    const glm::vec4 planes[5] = {{0, 0, 1, 1}, {1, 0, 0, vp.gx}, {-1, 0, 0, vp.gx}, {0, 1, 0, vp.gy}, {0, -1, 0, vp.gy}};
+    glm::vec4 buf[2][9];
+    int n = 3;
+    buf[0][0] = a;
+    buf[0][1] = b;
+    buf[0][2] = c;
+    int cur = 0;
+    for (const glm::vec4 &p : planes)
+    {
+        const glm::vec4 *in = buf[cur];
+        glm::vec4 *dst = buf[cur ^ 1];
+        int m = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            const glm::vec4 &u = in[i], &v = in[(i + 1) % n];
+            const float du = glm::dot(p, u), dv = glm::dot(p, v);
+            if (du >= 0)
+                dst[m++] = u;
+            if ((du >= 0) != (dv >= 0))
+                dst[m++] = u + (v - u) * (du / (du - dv));
+        }
+        n = m;
+        cur ^= 1;
+        if (n < 3)
+            return;
+    }
+    for (int i = 1; i + 1 < n; ++i)
+        setupTri(buf[cur][0], buf[cur][i], buf[cur][i + 1], mirrored, color, vp, out);
+}
+
+void setupPart(const PartInstance &part, const glm::mat4 &viewProj, const Viewport &vp,
+               std::vector<SoftRasterizer::Tri> &out)
+{
+    const glm::mat4 mvp = viewProj * part.model.toMat4();
+    glm::vec4 v[8];
+    unsigned code[8], all = ~0u, any = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        v[i] = mvp[3] + mvp[0] * kCorner[i][0] + mvp[1] * kCorner[i][1] + mvp[2] * kCorner[i][2];
+        code[i] = outcode(v[i], vp);
+        all &= code[i];
+        any |= code[i];
+    }
+    if (all & OutFrustum) // pièce entièrement hors du frustum
+        return;
+
+    // Un model à déterminant négatif inverse l'orientation des faces
+    const bool mirrored = determinant(part.model) < 0.0f;
+    const uint32_t color = packRGBA(part.color);
+    const bool needClip = any & (OutNear | OutGuard);
+
+    for (const auto &f : kFace)
+    {
+        if (code[f[0]] & code[f[1]] & code[f[2]] & OutFrustum)
+            continue;
+        if (needClip && ((code[f[0]] | code[f[1]] | code[f[2]]) & (OutNear | OutGuard)))
+            clipTri(v[f[0]], v[f[1]], v[f[2]], mirrored, color, vp, out);
+        else
+            setupTri(v[f[0]], v[f[1]], v[f[2]], mirrored, color, vp, out);
+    }
+}
+} // namespace
+
+// ---------------------- Rendu ----------------------
+
+// Une tranche = 256 pièces : setup assez long pour amortir le vol de jobs
+static const int kSetupGrain = 256;
+
+void SoftRasterizer::rasterTile(int tile, uint32_t clear, SoftFramebuffer &fb) const
+{
+    const int bx = (tile % tilesX_) * kSoftTile, by = (tile / tilesX_) * kSoftTile;
+    for (int y = by; y < by + kSoftTile; ++y)
+    {
+        std::fill_n(&fb.color[(size_t)y * fb.stride + bx], kSoftTile, clear);
+        std::fill_n(&fb.depth[(size_t)y * fb.stride + bx], kSoftTile, 1.0f);
+    }
+
+    for (const Tri *t : bins_[tile])
+    {
+        Span s;
+        s.x0 = std::max(t->x0, bx) & ~7;
+        s.x1 = std::min(t->x1, bx + kSoftTile - 1);
+        s.y0 = std::max(t->y0, by);
+        s.y1 = std::min(t->y1, by + kSoftTile - 1);
+        const int xEnd = (s.x1 | 7); // dernier pixel évalué par les blocs SIMD
+
+        bool reject = false;
+        for (int i = 0; i < 3 && !reject; ++i)
+        {
+            // Valeur aux coins de la zone : une arête linéaire y atteint ses extrêmes
+            auto edge = [&](int x, int y)
+            { return (int64_t)t->A[i] * (x * kSub + kSub / 2) + (int64_t)t->B[i] * (y * kSub + kSub / 2) + t->C[i]; };
+            const int64_t e00 = edge(s.x0, s.y0), e10 = edge(xEnd, s.y0);
+            const int64_t e01 = edge(s.x0, s.y1), e11 = edge(xEnd, s.y1);
+            const int64_t lo = std::min({e00, e10, e01, e11}), hi = std::max({e00, e10, e01, e11});
+            if (hi < 0)
+                reject = true;
+            else if (lo >= 0) // toute la zone est du bon côté
+                s.e[i] = s.dx[i] = s.dy[i] = 0;
+            else
+            {
+                // L'arête traverse la zone : |E| <= (|A| + |B|) * 16 * 64 < 2^30
+                s.e[i] = (int32_t)e00;
+                s.dx[i] = t->A[i] * kSub;
+                s.dy[i] = t->B[i] * kSub;
+            }
+        }
+        if (reject)
+            continue;
+
+        s.zdx = t->zdx;
+        s.zdy = t->zdy;
+        s.z = t->z + (s.x0 - t->x0) * t->zdx + (s.y0 - t->y0) * t->zdy;
+        s.color = t->color;
+        kernel_(s, fb);
+    }
+}
+
+void SoftRasterizer::render(const PartInstance *parts, size_t n, const glm::mat4 &viewProj,
+                            const glm::vec4 &clearColor, SoftFramebuffer &fb)
+{
+    Viewport vp;
+    vp.w = fb.width;
+    vp.h = fb.height;
+    vp.gx = kGuardPx * 2.0f / fb.width;
+    vp.gy = kGuardPx * 2.0f / fb.height;
+
+    // 1. Setup : une liste de triangles par tranche (pas de synchronisation)
+    const int count = (int)n;
+    chunks_.resize((count + kSetupGrain - 1) / kSetupGrain);
+    auto setup = [&](int begin, int end)
+    {
+        for (int c = begin / kSetupGrain; c * kSetupGrain < end; ++c)
+        {
+            std::vector<Tri> &out = chunks_[c];
+            out.clear();
+            const int last = std::min(end, (c + 1) * kSetupGrain);
+            for (int i = c * kSetupGrain; i < last; ++i)
+                setupPart(parts[i], viewProj, vp, out);
+        }
+    };
+    if (jobs_)
+        jobs_->parallelFor(count, kSetupGrain, setup);
+    else
+        setup(0, count);
+
+    // 2. Binning dans l'ordre de soumission (départage des profondeurs égales)
+    tilesX_ = fb.stride / kSoftTile;
+    tilesY_ = (fb.height + kSoftTile - 1) / kSoftTile;
+    bins_.resize((size_t)tilesX_ * tilesY_);
+    for (auto &b : bins_)
+        b.clear();
+    for (const auto &chunk : chunks_)
+        for (const Tri &t : chunk)
+            for (int ty = t.y0 / kSoftTile; ty <= t.y1 / kSoftTile; ++ty)
+                for (int tx = t.x0 / kSoftTile; tx <= t.x1 / kSoftTile; ++tx)
+                    bins_[ty * tilesX_ + tx].push_back(&t);
+
+    // 3. Tuiles indépendantes : clear + rastérisation
+    const uint32_t clear = packRGBA(clearColor);
+    auto raster = [&](int begin, int end)
+    {
+        for (int tile = begin; tile < end; ++tile)
+            rasterTile(tile, clear, fb);
+    };
+    if (jobs_)
+        jobs_->parallelFor(tilesX_ * tilesY_, 1, raster);
+    else
+        raster(0, tilesX_ * tilesY_);
+}